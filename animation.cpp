@@ -1,4 +1,29 @@
-template <typename T>
-struct Animation
-{
-};
\ No newline at end of file
+#include "observable.h"
+
+// Explicit instantiations for the float and int properties used throughout
+// the UI. Consumers linking the observer library see matching extern template
+// declarations (OBSERVER_EXTERN_TEMPLATES) and skip instantiating these again.
+
+template class ObserverList<float>;
+template class ObserverList<int>;
+
+template struct ObservableProperty<float>;
+template struct ObservableProperty<int>;
+
+template class ComputedProperty<float>;
+template class ComputedProperty<int>;
+
+template class AtomicProperty<float>;
+template class AtomicProperty<int>;
+
+template class Animation<float>;
+template class Animation<int>;
+template class KeyframeTrack<float>;
+template class KeyframeTrack<int>;
+template class KeyframeAnimation<float>;
+template class KeyframeAnimation<int>;
+
+template class AnimationGroup<Linear>;
+
+template class TypedAnimationBatch<Animation<float> >;
+template class TypedAnimationBatch<Animation<int> >;
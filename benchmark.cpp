@@ -0,0 +1,230 @@
+#include <benchmark/benchmark.h>
+
+#include "observable.h"
+
+// Long enough that no animation retires while a benchmark runs
+static const int64_t ENDLESS_MS = 1000000000;
+// One 120 Hz frame in microseconds
+static const int64_t FRAME_US = 8333;
+
+/**
+ * @brief ObservableProperty::operator= with state.range(0) observers attached
+ */
+static void BM_PropertyAssign(benchmark::State &state)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+
+    int64_t fired = 0;
+    for (int64_t i = 0; i < state.range(0); i++)
+    {
+        property.add_observer([&fired](float, float)
+                              { fired++; });
+    }
+
+    float next = 0.0f;
+    for (auto _ : state)
+    {
+        property = next;
+        next += 1.0f;
+    }
+
+    benchmark::DoNotOptimize(fired);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PropertyAssign)->Arg(0)->Arg(1)->Arg(8)->Arg(64);
+
+/**
+ * @brief Constructing and destroying a View with its default observers
+ */
+static void BM_ViewConstruction(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        View view;
+        benchmark::DoNotOptimize(&view);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ViewConstruction);
+
+/**
+ * @brief Writing every view's width, state.range(0) ObservableProperty-based Views against PackedViews
+ */
+static void BM_ViewWidthPass(benchmark::State &state)
+{
+    size_t count = (size_t)state.range(0);
+    std::vector<std::unique_ptr<View> > views;
+    for (size_t i = 0; i < count; i++)
+    {
+        views.emplace_back(new View());
+    }
+
+    float width = 0.0f;
+    for (auto _ : state)
+    {
+        for (auto &view : views)
+        {
+            view->frame.size.width = width;
+        }
+        width += 1.0f;
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ViewWidthPass)->Arg(10000);
+
+static void BM_PackedViewWidthPass(benchmark::State &state)
+{
+    size_t count = (size_t)state.range(0);
+    std::unique_ptr<PackedView[]> views(new PackedView[count]);
+
+    float width = 0.0f;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            views[i].width() = width;
+        }
+        width += 1.0f;
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PackedViewWidthPass)->Arg(10000);
+
+/**
+ * @brief Animation<T>::tick over state.range(0) independent animations, one frame per iteration
+ */
+template <typename T>
+static void BM_AnimationTick(benchmark::State &state)
+{
+    size_t count = (size_t)state.range(0);
+    std::vector<ObservableProperty<T> > properties(count);
+    std::vector<Animation<T> > animations(count);
+
+    int64_t now = AnimationCore::now_us();
+    for (size_t i = 0; i < count; i++)
+    {
+        animations[i].property = &properties[i];
+        animations[i].start = (T)0;
+        animations[i].end = (T)i;
+        animations[i].duration = ENDLESS_MS;
+        animations[i].prep(now);
+    }
+
+    for (auto _ : state)
+    {
+        now += FRAME_US;
+        for (auto &animation : animations)
+        {
+            animation.tick(now);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK_TEMPLATE(BM_AnimationTick, float)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_AnimationTick, int)->RangeMultiplier(10)->Range(1000, 1000000);
+
+/**
+ * @brief AnimationScheduler::tick for one frame over state.range(0) float animations
+ *
+ * state.range(1) selects a worker pool with that many extra threads, 0 for single-threaded.
+ */
+static void BM_SchedulerFrame(benchmark::State &state)
+{
+    size_t count = (size_t)state.range(0);
+    std::vector<ObservableProperty<float> > properties(count);
+
+    std::unique_ptr<AnimationWorkerPool> pool;
+    AnimationScheduler scheduler;
+    if (state.range(1) > 0)
+    {
+        pool.reset(new AnimationWorkerPool((size_t)state.range(1)));
+        scheduler.set_workers(pool.get());
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        Animation<float> animation;
+        animation.property = &properties[i];
+        animation.start = 0.0f;
+        animation.end = (float)i;
+        animation.duration = ENDLESS_MS;
+        scheduler.add(animation);
+    }
+
+    int64_t now = AnimationCore::now_us();
+    for (auto _ : state)
+    {
+        now += FRAME_US;
+        scheduler.tick(now);
+    }
+
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_SchedulerFrame)
+    ->ArgsProduct({{1000, 10000, 100000, 1000000}, {0}})
+    ->Args({100000, 3})
+    ->Args({1000000, 3})
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief AnimationScheduler::tick for one frame over state.range(0) pooled int animations
+ */
+static void BM_SchedulerFramePooled(benchmark::State &state)
+{
+    size_t count = (size_t)state.range(0);
+    std::vector<ObservableProperty<int> > properties(count);
+    AnimationScheduler scheduler;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        Animation<int> animation;
+        animation.property = &properties[i];
+        animation.start = 0;
+        animation.end = (int)i;
+        animation.duration = ENDLESS_MS;
+        scheduler.add(animation);
+    }
+
+    int64_t now = AnimationCore::now_us();
+    for (auto _ : state)
+    {
+        now += FRAME_US;
+        scheduler.tick(now);
+    }
+
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_SchedulerFramePooled)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief PhysicsAnimationStore::tick for one frame over state.range(0) springs
+ *
+ * Springs are undamped so none of them settle and retire during the run.
+ */
+static void BM_SpringFrame(benchmark::State &state)
+{
+    size_t count = (size_t)state.range(0);
+    std::vector<ObservableProperty<float> > properties(count);
+    PhysicsAnimationStore store;
+
+    SpringConfig config;
+    config.damping = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        store.spring(&properties[i], 0.0f, 0.0f, (float)i, config, 0);
+    }
+
+    int64_t now = 0;
+    for (auto _ : state)
+    {
+        now += FRAME_US;
+        store.tick(now);
+    }
+
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_SpringFrame)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
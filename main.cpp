@@ -1,215 +1,21 @@
-#include <iostream>
-#include <vector>
-#include <functional>
-#include <chrono>
-#include <ctime>
-#include <thread>
-
-using std::chrono::duration_cast;
-using std::chrono::milliseconds;
-using std::chrono::seconds;
-using std::chrono::system_clock;
-
-#define UIFloat ObservableProperty<float>
-#define UIInt ObservableProperty<int>
-
-template <typename T>
-struct ObservableProperty
-{
-    T value;
-    std::vector<std::function<void(T, T)> > observers;
-
-    inline void
-    operator=(const T new_value)
-    {
-        for (auto observer : this->observers)
-        {
-            observer(this->value, new_value);
-        }
-        this->value = new_value;
-    }
-
-    /**
-     * @brief Observer will be called in the event that the backing value changes
-     *
-     * @param observer Lambda to be called
-     */
-    void add_observer(std::function<void(T, T)> observer)
-    {
-        this->observers.push_back(observer);
-    }
-};
-
-class AnimationCore
-{
-public:
-    static int64_t now()
-    {
-        return duration_cast<milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
-    }
-};
-
-/**
- * @brief Abstract linear interpolation
- *
- * @tparam T
- * @param start
- * @param end
- * @param prog
- * @return T
- */
-template <typename T>
-T lerp(T start, T end, double prog)
-{
-    return (T)start + (prog * (end - start));
-}
-
-template <typename T>
-class Animation
-{
-private:
-    int64_t start_time;
-    int64_t end_time;
-
-public:
-    /**
-     * @brief Sets up start and end times for an animation
-     *
-     */
-    void prep()
-    {
-        int64_t now = AnimationCore::now();
-        this->start_time = now;
-        this->end_time = now + this->duration;
-    }
-
-    ObservableProperty<T> *property;
-    T start;
-    T end;
-
-    int64_t duration;
-
-    /**
-     * @brief Get the progress object
-     *
-     * @param now Timestamp in milliseconds representing the current time
-     * @return float Normalized range between 0.0 and 1.0 representing animation progress
-     */
-    float get_progress(int64_t now)
-    {
-        int64_t delta = now - this->start_time;
-
-        if (delta == 0)
-        {
-            return 0.0f;
-        }
-
-        float dt = (float)((double)delta / (double)this->duration);
-        return dt;
-    }
-
-    /**
-     * @brief Returns value of an
-     *
-     * @param prog Normalized range between 0.0 and 1.0 representing animation progress
-     * @return T Whatever the value is. For example, float, int, or Color
-     */
-    T get_value_for_progress(float prog)
-    {
-        return lerp(this->start, this->end, prog);
-    }
-
-    /**
-     * @brief Progresses the animation given the current timestamp
-     *
-     * @param now Time in ms that has elapsed since the steady_clock epoch
-     */
-    void tick(int64_t now)
-    {
-        float prog = this->get_progress(now);
-
-        if (prog > 1)
-        {
-            this->property->value = this->end;
-        }
-        else if (prog < 0)
-        {
-            this->property->value = this->start;
-        }
-        else
-        {
-            this->property->value = this->get_value_for_progress(prog);
-        }
-    }
-
-    /**
-     * @brief
-     *
-     * @param now Time in ms that has elapsed since the steady_clock epoch
-     * @return true The animation has finished
-     * @return false The animation is in progress
-     */
-    bool finished(int64_t now)
-    {
-        return this->get_progress(now) >= 1.0;
-    }
-};
-
-struct Point
-{
-    UIFloat x;
-    UIFloat y;
-};
-
-struct Size
-{
-    UIFloat width;
-    UIFloat height;
-};
-
-struct Rect
-{
-    Point position;
-    Size size;
-};
-
-struct Color
-{
-    UIInt r;
-    UIInt g;
-    UIInt b;
-};
-
-class View
-{
-public:
-    Color color;
-    Rect frame;
-
-    View()
-    {
-        this->frame.size.width.add_observer(
-            [](float old, float current)
-            {
-                std::cout << "old width: " << old << "\n";
-                std::cout << "current width: " << current << "\n";
-            });
-        this->frame.size.height.add_observer(
-            [](float old, float current)
-            {
-                std::cout << "old height: " << old << "\n";
-                std::cout << "current height: " << current << "\n";
-            });
-    }
-};
+#include "observable.h"
 
 int main()
 {
+#if OBSERVER_TRACE_ENABLED
+    // Diagnostics are buffered and written by a background thread, off the frame path
+    StreamTraceSink sink(std::cout);
+    TraceLog::global().set_sink(&sink);
+#endif
+
     // Example view
     View *my_view = new View();
 
+    // Every animation in the process is driven by a single scheduler
+    AnimationScheduler scheduler;
+
     // Animate function observer when value is changed
-    auto observe = [&my_view](float old, float current)
+    auto observe = [&my_view, &scheduler](float old, float current)
     {
         // Create new animation for the current property
         Animation<float> anim;
@@ -218,27 +24,10 @@ int main()
         anim.end = current;
         anim.duration = 250; // ms
 
-        // Print start and end values
-        std::cout << "start: " << anim.start;
-        std::cout << " | end: " << anim.end << "\n";
-
-        // Setup start and end times for the animation
-        anim.prep();
-
-        int64_t now = AnimationCore::now();
+        OBSERVER_TRACE("animate width", anim.start, anim.end);
 
-        // Run animation until it's complete
-        while (!anim.finished(now))
-        {
-            // Tick using the delta from the relative steady_clock epoch
-            now = AnimationCore::now();
-            anim.tick(now);
-
-            std::cout << "Current value: " << anim.property->value << "\n";
-
-            // Update at 120hz
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000 / 120));
-        }
+        // Scheduler sets up start and end times and advances it every frame
+        scheduler.add(anim);
     };
 
     // Add observer function to be called on width change
@@ -246,4 +35,28 @@ int main()
 
     // Observer function will be called on assignment
     my_view->frame.size.width = 500.64f;
+
+    // Paces frames at 120hz against absolute deadlines until every animation has retired
+    FrameDriver driver(scheduler, 120);
+
+    float old_width = my_view->frame.size.width.value;
+    driver.set_frame_callback([&my_view, &old_width](int64_t)
+                              {
+                                  OBSERVER_TRACE("tick width", old_width, my_view->frame.size.width.value);
+                                  old_width = my_view->frame.size.width.value;
+                              });
+    driver.run_until_idle();
+
+#if OBSERVER_TRACE_ENABLED
+    // Flush pending records before the sink goes out of scope
+    TraceLog::global().set_sink(nullptr);
+#endif
+
+    std::cout << "Final value: " << my_view->frame.size.width.value << "\n";
+    std::cout << "Frames: " << driver.frames() << " | missed: " << driver.missed_frames() << "\n";
+
+#if OBSERVER_INSTRUMENTATION
+    std::cout << "Frame time p50: " << AnimationStats::frame_percentile(0.5) << "us";
+    std::cout << " | p99: " << AnimationStats::frame_percentile(0.99) << "us\n";
+#endif
 }
\ No newline at end of file
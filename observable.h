@@ -0,0 +1,28 @@
+#pragma once
+
+// Everything in the library; the headers under observer/ can also be included individually
+#include "observer/common.h"
+#include "observer/stats.h"
+#include "observer/containers.h"
+#include "observer/observer_list.h"
+#include "observer/property.h"
+#include "observer/computed.h"
+#include "observer/atomic_property.h"
+#include "observer/trace.h"
+#include "observer/animation_core.h"
+#include "observer/interpolation.h"
+#include "observer/easing.h"
+#include "observer/animation.h"
+#include "observer/animation_pool.h"
+#include "observer/batch.h"
+#include "observer/float_store.h"
+#include "observer/worker_pool.h"
+#include "observer/group.h"
+#include "observer/scheduler.h"
+#include "observer/frame_driver.h"
+#include "observer/physics.h"
+#include "observer/geometry.h"
+#include "observer/composite.h"
+#include "observer/view.h"
+#include "observer/packed_view.h"
+#include "observer/snapshot.h"
@@ -0,0 +1,346 @@
+#pragma once
+
+#include "animation_core.h"
+#include "easing.h"
+#include "interpolation.h"
+#include "property.h"
+
+/**
+ * @brief Result of advancing an animation by one frame
+ */
+template <typename T>
+struct AnimationStep
+{
+    T value;
+    // The animation reached its end on this step
+    bool completed;
+    // Nothing was written and nothing will be until the animation is resumed
+    bool idle = false;
+};
+
+/**
+ * @brief Animates an ObservableProperty from start to end over duration
+ *
+ * @tparam T Value type
+ * @tparam Easing Curve type with a static apply(t), see Linear
+ */
+template <typename T, typename Easing = Linear>
+class Animation
+{
+private:
+    int64_t start_time;
+    int64_t end_time;
+    // 1 / duration in microseconds, so progress is a multiply per frame
+    double inv_duration;
+
+public:
+    /**
+     * @brief Sets up start and end times for an animation starting at AnimationCore::start_time()
+     */
+    void prep()
+    {
+        this->prep(AnimationCore::start_time());
+    }
+
+    /**
+     * @brief Sets up start and end times for an animation starting at a given time
+     *
+     * @param now Start time in microseconds since the steady_clock epoch
+     */
+    void prep(int64_t now)
+    {
+        this->start_time = now;
+        this->end_time = now + this->duration * 1000;
+        this->inv_duration = 1.0 / ((double)std::max<int64_t>(this->duration, 1) * 1000.0);
+    }
+
+    /**
+     * @return int64_t Timestamp in microseconds the animation was prepped at
+     */
+    int64_t get_start_time() const
+    {
+        return this->start_time;
+    }
+
+    ObservableProperty<T> *property;
+    T start;
+    T end;
+
+    // In milliseconds
+    int64_t duration;
+
+    /**
+     * @brief Get the progress object
+     *
+     * @param now Timestamp in microseconds representing the current time
+     * @return float Normalized range between 0.0 and 1.0 representing animation progress
+     */
+    float get_progress(int64_t now)
+    {
+        int64_t delta = now - this->start_time;
+
+        if (delta == 0)
+        {
+            return 0.0f;
+        }
+
+        float dt = (float)((double)delta * this->inv_duration);
+        return dt;
+    }
+
+    /**
+     * @brief Returns value of an
+     *
+     * @param prog Normalized range between 0.0 and 1.0 representing animation progress
+     * @return T Whatever the value is. For example, float, int, or Color
+     */
+    T get_value_for_progress(float prog)
+    {
+        return lerp(this->start, this->end, Easing::apply(prog));
+    }
+
+    /**
+     * @brief Progresses the animation and reports whether it has completed, in one evaluation
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     * @return AnimationStep<T> Value written to the property and completion status
+     */
+    AnimationStep<T> advance(int64_t now)
+    {
+        float prog = this->get_progress(now);
+        AnimationStep<T> step;
+
+        if (prog >= 1)
+        {
+            step.value = this->end;
+        }
+        else if (prog < 0)
+        {
+            step.value = this->start;
+        }
+        else
+        {
+            step.value = this->get_value_for_progress(prog);
+        }
+        step.completed = prog >= 1;
+
+        this->property->store(step.value);
+        return step;
+    }
+
+    /**
+     * @brief Progresses the animation given the current timestamp
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     */
+    void tick(int64_t now)
+    {
+        this->advance(now);
+    }
+
+    /**
+     * @brief
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     * @return true The animation has finished
+     * @return false The animation is in progress
+     */
+    bool finished(int64_t now)
+    {
+        return this->get_progress(now) >= 1.0;
+    }
+};
+
+/**
+ * @brief Multi-keyframe track of values over time
+ *
+ * Keyframe times and values are stored in contiguous arrays. Each segment
+ * between consecutive keyframes has its own easing, stored as a plain function
+ * pointer such as &EaseInOut::apply. A track holds no playback state, so one
+ * track can drive any number of KeyframeAnimation instances.
+ *
+ * @tparam T Value type
+ */
+template <typename T>
+class KeyframeTrack
+{
+public:
+    typedef float (*EasingFunction)(float);
+
+private:
+    // In milliseconds from the start of the track, ascending
+    std::vector<float> times;
+    std::vector<T> values;
+    // easings[i] shapes the segment from keyframe i to keyframe i + 1
+    std::vector<EasingFunction> easings;
+
+public:
+    /**
+     * @brief Appends a keyframe
+     *
+     * @param time Time in ms from the start of the track, not before the previous keyframe
+     * @param value Value at that time
+     * @param easing Easing of the segment leading away from this keyframe
+     */
+    void add(float time, T value, EasingFunction easing = &Linear::apply)
+    {
+        this->times.push_back(time);
+        this->values.push_back(value);
+        this->easings.push_back(easing);
+    }
+
+    size_t size() const
+    {
+        return this->times.size();
+    }
+
+    /**
+     * @return float Time of the last keyframe in ms
+     */
+    float duration() const
+    {
+        return this->times.empty() ? 0.0f : this->times.back();
+    }
+
+    /**
+     * @brief Samples the track, reusing and updating a cached segment index
+     *
+     * Monotonically advancing time steps the cached segment forward, so lookup
+     * is O(1) amortized; jumps backwards or far ahead fall back to a binary
+     * search.
+     *
+     * @param time Time in ms from the start of the track
+     * @param segment Cached segment index, start at 0 and keep it between calls
+     * @return T Value at time, clamped to the first and last keyframes, or T() for an empty track
+     */
+    T sample(float time, size_t &segment) const
+    {
+        size_t count = this->times.size();
+        if (count == 0)
+        {
+            segment = 0;
+            return T();
+        }
+        if (count == 1 || time <= this->times.front())
+        {
+            segment = 0;
+            return this->values.front();
+        }
+        if (time >= this->times.back())
+        {
+            segment = count - 2;
+            return this->values.back();
+        }
+
+        // A few forward steps cover every frame of normal playback
+        if (segment >= count - 1 || time < this->times[segment])
+        {
+            segment = this->find_segment(time);
+        }
+        for (int steps = 0; time >= this->times[segment + 1]; steps++)
+        {
+            if (steps == 4)
+            {
+                segment = this->find_segment(time);
+                break;
+            }
+            segment++;
+        }
+
+        float from = this->times[segment];
+        float local = (time - from) / (this->times[segment + 1] - from);
+        return lerp(this->values[segment], this->values[segment + 1], this->easings[segment](local));
+    }
+
+    /**
+     * @param time Time in ms strictly inside the track
+     * @return size_t Segment whose start is the last keyframe at or before time
+     */
+    size_t find_segment(float time) const
+    {
+        auto next = std::upper_bound(this->times.begin(), this->times.end(), time);
+        return (size_t)(next - this->times.begin()) - 1;
+    }
+};
+
+/**
+ * @brief Plays a KeyframeTrack into an ObservableProperty
+ *
+ * @tparam T Value type
+ */
+template <typename T>
+class KeyframeAnimation
+{
+private:
+    int64_t start_time;
+    size_t segment = 0;
+
+public:
+    ObservableProperty<T> *property;
+    // Shared track, must outlive the animation
+    const KeyframeTrack<T> *track;
+
+    /**
+     * @brief Starts the animation at AnimationCore::start_time()
+     */
+    void prep()
+    {
+        this->prep(AnimationCore::start_time());
+    }
+
+    /**
+     * @param now Start time in microseconds since the steady_clock epoch
+     */
+    void prep(int64_t now)
+    {
+        this->start_time = now;
+        this->segment = 0;
+    }
+
+    /**
+     * @brief Moves the playhead so that the track is at time at the given moment
+     *
+     * @param now Current time in microseconds
+     * @param time Track time in ms to jump to
+     */
+    void seek(int64_t now, float time)
+    {
+        this->start_time = now - (int64_t)((double)time * 1000.0);
+    }
+
+    /**
+     * @brief Progresses the animation and reports whether the track has ended
+     *
+     * An empty track completes immediately and leaves the property untouched.
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     * @return AnimationStep<T> Value written to the property and completion status
+     */
+    AnimationStep<T> advance(int64_t now)
+    {
+        float time = (float)((double)(now - this->start_time) * 0.001);
+
+        AnimationStep<T> step;
+        if (this->track->size() == 0)
+        {
+            step.value = this->property->value;
+            step.completed = true;
+            return step;
+        }
+
+        step.value = this->track->sample(time, this->segment);
+        step.completed = time >= this->track->duration();
+
+        this->property->store(step.value);
+        return step;
+    }
+};
+
+#if OBSERVER_EXTERN_TEMPLATES
+extern template class Animation<float>;
+extern template class Animation<int>;
+extern template class KeyframeTrack<float>;
+extern template class KeyframeTrack<int>;
+extern template class KeyframeAnimation<float>;
+extern template class KeyframeAnimation<int>;
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "stats.h"
+
+class AnimationCore
+{
+private:
+    static int64_t &frame_timestamp()
+    {
+        static int64_t value = 0;
+        return value;
+    }
+
+    // Between begin_frame and end_frame
+    static bool &frame_open()
+    {
+        static bool value = false;
+        return value;
+    }
+
+public:
+    static int64_t now()
+    {
+        return duration_cast<milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @return int64_t Microseconds that have elapsed since the steady_clock epoch
+     */
+    static int64_t now_us()
+    {
+        return duration_cast<microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Starts a frame by sampling the clock once
+     *
+     * Every animation ticked during the frame should be handed the returned
+     * timestamp rather than reading the clock itself.
+     *
+     * @return int64_t Frame timestamp in microseconds
+     */
+    static int64_t begin_frame()
+    {
+        return begin_frame(now_us());
+    }
+
+    /**
+     * @brief Starts a frame at an externally supplied time, for example a vsync timestamp
+     *
+     * @param timestamp_us Frame time in microseconds on the steady_clock timeline
+     * @return int64_t Frame timestamp in microseconds
+     */
+    static int64_t begin_frame(int64_t timestamp_us)
+    {
+        frame_timestamp() = timestamp_us;
+        frame_open() = true;
+#if OBSERVER_INSTRUMENTATION
+        AnimationStats::begin_frame(timestamp_us);
+#endif
+        return timestamp_us;
+    }
+
+    /**
+     * @brief Ends the frame started by begin_frame
+     *
+     * With OBSERVER_INSTRUMENTATION it also closes the frame's AnimationStats
+     * and records its duration.
+     */
+    static void end_frame()
+    {
+        frame_open() = false;
+#if OBSERVER_INSTRUMENTATION
+        AnimationStats::end_frame(now_us());
+#endif
+    }
+
+    /**
+     * @return int64_t Timestamp of the current frame in microseconds, as set by begin_frame
+     */
+    static int64_t frame_time()
+    {
+        return frame_timestamp();
+    }
+
+    /**
+     * @brief Time an animation created now starts at
+     *
+     * Inside a frame this is the frame timestamp, so everything started while
+     * a frame runs shares the one clock sample it is ticked with. Between
+     * frames it is the clock, but never earlier than the last frame, so an
+     * animation never starts ahead of the timestamps it will be ticked with.
+     *
+     * @return int64_t Start time in microseconds
+     */
+    static int64_t start_time()
+    {
+        if (frame_open())
+        {
+            return frame_timestamp();
+        }
+        return std::max(now_us(), frame_timestamp());
+    }
+
+    /**
+     * @brief Blocks until an absolute deadline
+     *
+     * Sleeps until shortly before the deadline, then spins for the rest, since
+     * an OS sleep alone routinely wakes up late by more than a frame's slack.
+     *
+     * @param deadline_us Steady clock time in microseconds, see now_us
+     * @param spin_us How long before the deadline to stop sleeping and spin
+     * @return int64_t Time the wait returned, in microseconds
+     */
+    static int64_t wait_until(int64_t deadline_us, int64_t spin_us)
+    {
+        int64_t now = now_us();
+        if (deadline_us - spin_us > now)
+        {
+            std::this_thread::sleep_until(std::chrono::steady_clock::time_point(microseconds(deadline_us - spin_us)));
+            now = now_us();
+        }
+        while (now < deadline_us)
+        {
+            now = now_us();
+        }
+        return now;
+    }
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * @brief Stable reference to an animation stored in an AnimationPool
+ *
+ * Stays valid while the animation is alive; once it is released the
+ * generation no longer matches and lookups return nullptr.
+ */
+struct AnimationHandle
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool valid() const
+    {
+        return this->generation != 0;
+    }
+};
+
+/**
+ * @brief Fixed-block pool of animations with stable handles
+ *
+ * Animations live in blocks of BlockSize that are never moved or freed until
+ * the pool is destroyed, and released slots go onto a free list, so starting
+ * and finishing animations at a steady rate never reaches the global
+ * allocator. Live animations are also tracked densely so a frame can walk
+ * them without visiting free slots.
+ *
+ * Between begin_pass and end_pass a released animation stops being live
+ * straight away but is only destroyed at end_pass, so a callback run from an
+ * animation can cancel or replace that same animation while it is executing.
+ *
+ * @tparam A Animation type
+ * @tparam BlockSize Animations per block
+ */
+template <typename A, size_t BlockSize = 256>
+class AnimationPool
+{
+private:
+    struct Block
+    {
+        alignas(A) unsigned char storage[BlockSize * sizeof(A)];
+    };
+
+    struct Slot
+    {
+        uint32_t generation = 1;
+        // Position in dense while alive
+        uint32_t dense = UINT32_MAX;
+    };
+
+    std::vector<std::unique_ptr<Block> > blocks;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_list;
+    std::vector<uint32_t> dense;
+    // Released during a pass, destroyed by end_pass
+    std::vector<uint32_t> pending;
+    bool in_pass = false;
+
+    A *at(uint32_t index)
+    {
+        return reinterpret_cast<A *>(this->blocks[index / BlockSize]->storage) + index % BlockSize;
+    }
+
+    uint32_t grab_index()
+    {
+        if (!this->free_list.empty())
+        {
+            uint32_t index = this->free_list.back();
+            this->free_list.pop_back();
+            return index;
+        }
+        if (this->slots.size() == this->blocks.size() * BlockSize)
+        {
+            this->blocks.emplace_back(new Block());
+        }
+        this->slots.emplace_back();
+        return (uint32_t)this->slots.size() - 1;
+    }
+
+public:
+    AnimationPool() = default;
+    AnimationPool(const AnimationPool &) = delete;
+    AnimationPool &operator=(const AnimationPool &) = delete;
+
+    ~AnimationPool()
+    {
+        this->end_pass();
+        this->reset();
+    }
+
+    /**
+     * @brief Moves an animation into the pool
+     *
+     * @param animation Animation to store
+     * @return AnimationHandle Stable handle to the stored animation
+     */
+    AnimationHandle acquire(A animation)
+    {
+        uint32_t index = this->grab_index();
+        new (this->at(index)) A(std::move(animation));
+
+        Slot &slot = this->slots[index];
+        slot.dense = (uint32_t)this->dense.size();
+        this->dense.push_back(index);
+
+        return AnimationHandle{index, slot.generation};
+    }
+
+    /**
+     * @param handle Handle returned by acquire
+     * @return A* The animation, or nullptr once it has been released
+     */
+    A *get(AnimationHandle handle)
+    {
+        if (handle.index >= this->slots.size() || this->slots[handle.index].generation != handle.generation)
+        {
+            return nullptr;
+        }
+        return this->at(handle.index);
+    }
+
+    /**
+     * @brief Destroys an animation and returns its slot to the free list
+     *
+     * @param handle Handle returned by acquire
+     * @return true The animation was alive and has been released
+     */
+    bool release(AnimationHandle handle)
+    {
+        if (!this->get(handle))
+        {
+            return false;
+        }
+
+        Slot &slot = this->slots[handle.index];
+        if (!this->in_pass)
+        {
+            this->at(handle.index)->~A();
+        }
+        if (++slot.generation == 0)
+        {
+            slot.generation = 1;
+        }
+
+        // Swap-and-pop the dense entry, it carries no ordering
+        uint32_t moved = this->dense.back();
+        this->dense[slot.dense] = moved;
+        this->slots[moved].dense = slot.dense;
+        this->dense.pop_back();
+        slot.dense = UINT32_MAX;
+
+        (this->in_pass ? this->pending : this->free_list).push_back(handle.index);
+        return true;
+    }
+
+    /**
+     * @brief Defers destruction of released animations until end_pass
+     */
+    void begin_pass()
+    {
+        this->in_pass = true;
+    }
+
+    /**
+     * @brief Destroys the animations released since begin_pass and frees their slots
+     */
+    void end_pass()
+    {
+        this->in_pass = false;
+        for (uint32_t index : this->pending)
+        {
+            this->at(index)->~A();
+            this->free_list.push_back(index);
+        }
+        this->pending.clear();
+    }
+
+    /**
+     * @brief Releases every animation at once while keeping all blocks for reuse
+     *
+     * Meant for per-frame arenas of one-shot animations.
+     */
+    void reset()
+    {
+        for (uint32_t index : this->dense)
+        {
+            if (!this->in_pass)
+            {
+                this->at(index)->~A();
+            }
+            Slot &slot = this->slots[index];
+            if (++slot.generation == 0)
+            {
+                slot.generation = 1;
+            }
+            slot.dense = UINT32_MAX;
+            (this->in_pass ? this->pending : this->free_list).push_back(index);
+        }
+        this->dense.clear();
+    }
+
+    /**
+     * @return size_t Number of live animations
+     */
+    size_t size() const
+    {
+        return this->dense.size();
+    }
+
+    /**
+     * @param i Dense position, 0 <= i < size()
+     * @return A& The i-th live animation, in no particular order
+     */
+    A &live(size_t i)
+    {
+        return *this->at(this->dense[i]);
+    }
+
+    /**
+     * @param i Dense position, 0 <= i < size()
+     * @return AnimationHandle Handle of the i-th live animation
+     */
+    AnimationHandle live_handle(size_t i)
+    {
+        uint32_t index = this->dense[i];
+        return AnimationHandle{index, this->slots[index].generation};
+    }
+};
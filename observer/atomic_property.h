@@ -0,0 +1,511 @@
+#pragma once
+
+#include "property.h"
+#include "stats.h"
+
+/**
+ * @brief Lock-free storage for values std::atomic handles natively, such as float and int
+ */
+template <typename T>
+class LockFreeValue
+{
+private:
+    std::atomic<T> value;
+
+public:
+    explicit LockFreeValue(T initial = T()) : value(initial)
+    {
+    }
+
+    T load() const
+    {
+        return this->value.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Replaces the value unless ChangePolicy considers the write unchanged
+     *
+     * @param new_value Value to write
+     * @param old Receives the value that was replaced, or the current one if nothing was written
+     * @return true The value was written
+     */
+    template <typename ChangePolicy>
+    bool update(const T &new_value, T &old)
+    {
+        old = this->value.load(std::memory_order_relaxed);
+        do
+        {
+            if (ChangePolicy::unchanged(old, new_value))
+            {
+                return false;
+            }
+        } while (!this->value.compare_exchange_weak(old, new_value, std::memory_order_acq_rel,
+                                                    std::memory_order_relaxed));
+        return true;
+    }
+};
+
+/**
+ * @brief Seqlock storage for trivially copyable values too large for a lock-free std::atomic
+ *
+ * Readers never block: they copy the value and retry if a writer was active
+ * meanwhile. Writers exclude each other by spinning on the sequence.
+ */
+template <typename T>
+class SeqLockValue
+{
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Odd while a writer is active
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint64_t> words[WORDS];
+
+    void read_words(uint64_t *copy) const
+    {
+        for (size_t w = 0; w < WORDS; w++)
+        {
+            copy[w] = this->words[w].load(std::memory_order_relaxed);
+        }
+    }
+
+    void write_words(const T &value)
+    {
+        uint64_t copy[WORDS] = {};
+        std::memcpy(copy, &value, sizeof(T));
+        for (size_t w = 0; w < WORDS; w++)
+        {
+            this->words[w].store(copy[w], std::memory_order_relaxed);
+        }
+    }
+
+    static T from_words(const uint64_t *copy)
+    {
+        T value;
+        std::memcpy(&value, copy, sizeof(T));
+        return value;
+    }
+
+public:
+    explicit SeqLockValue(T initial = T())
+    {
+        this->write_words(initial);
+    }
+
+    T load() const
+    {
+        uint64_t copy[WORDS];
+        for (;;)
+        {
+            uint32_t before = this->sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                continue;
+            }
+            this->read_words(copy);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (this->sequence.load(std::memory_order_relaxed) == before)
+            {
+                return from_words(copy);
+            }
+        }
+    }
+
+    template <typename ChangePolicy>
+    bool update(const T &new_value, T &old)
+    {
+        uint32_t seq = this->sequence.load(std::memory_order_relaxed);
+        while ((seq & 1) || !this->sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                                                   std::memory_order_relaxed))
+        {
+            seq = this->sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint64_t copy[WORDS];
+        this->read_words(copy);
+        old = from_words(copy);
+
+        if (ChangePolicy::unchanged(old, new_value))
+        {
+            // Nothing was modified, so restoring the old sequence is safe for readers
+            this->sequence.store(seq, std::memory_order_release);
+            return false;
+        }
+
+        this->write_words(new_value);
+        this->sequence.store(seq + 2, std::memory_order_release);
+        return true;
+    }
+};
+
+/**
+ * @brief Bounded multi-producer, single-consumer queue of pending notifications
+ *
+ * Writers on any thread push without locking; one designated thread, usually
+ * the UI or frame thread, calls drain() to deliver. Properties coalesce their
+ * writes so each occupies at most one entry between drains, which means a
+ * capacity of at least the number of properties using the queue never fills.
+ */
+class DispatchQueue
+{
+public:
+    struct Notification
+    {
+        void *property;
+        void (*deliver)(void *);
+    };
+
+private:
+    MpscRing<Notification> notifications;
+    std::atomic<size_t> overflows{0};
+
+    // Properties destroyed with an entry still queued, each skips one entry
+    std::mutex cancel_lock;
+    std::vector<void *> cancelled;
+    std::atomic<size_t> cancel_count{0};
+
+    /**
+     * @return true The entry belongs to a destroyed property and was consumed
+     */
+    bool discard(void *property)
+    {
+        std::lock_guard<std::mutex> lock(this->cancel_lock);
+        auto found = std::find(this->cancelled.begin(), this->cancelled.end(), property);
+        if (found == this->cancelled.end())
+        {
+            return false;
+        }
+        *found = this->cancelled.back();
+        this->cancelled.pop_back();
+        this->cancel_count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+public:
+    /**
+     * @param capacity Maximum pending notifications, rounded up to a power of two
+     */
+    explicit DispatchQueue(size_t capacity = 1024) : notifications(capacity)
+    {
+    }
+
+    DispatchQueue(const DispatchQueue &) = delete;
+    DispatchQueue &operator=(const DispatchQueue &) = delete;
+
+    /**
+     * @brief Enqueues a notification, callable from any thread
+     *
+     * @param notification Property and the function delivering its notification
+     * @return true Enqueued
+     * @return false The queue was full, the notification was dropped and counted
+     */
+    bool push(Notification notification)
+    {
+        if (!this->notifications.push(notification))
+        {
+            this->overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Withdraws the entry a property being destroyed still has queued
+     *
+     * The entry stays in the ring and is skipped by drain(), so the property's
+     * address may be reused by another one immediately.
+     *
+     * @param property Property whose one queued entry should never be delivered
+     */
+    void cancel(void *property)
+    {
+        std::lock_guard<std::mutex> lock(this->cancel_lock);
+        this->cancelled.push_back(property);
+        this->cancel_count.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Delivers every pending notification, call only from the designated thread
+     *
+     * Notifications pushed while draining are delivered in the same call.
+     *
+     * @return size_t Number of notifications delivered
+     */
+    size_t drain()
+    {
+        ANIMATION_PHASE("dispatch", dispatch_us);
+        size_t delivered = 0;
+        Notification notification;
+        while (this->notifications.pop(notification))
+        {
+            if (this->cancel_count.load(std::memory_order_acquire) != 0 && this->discard(notification.property))
+            {
+                continue;
+            }
+            notification.deliver(notification.property);
+            delivered++;
+        }
+        return delivered;
+    }
+
+    /**
+     * @return size_t Notifications dropped because the queue was full
+     */
+    size_t overflowed() const
+    {
+        return this->overflows.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief ObservableProperty variant that may be written and read from any thread
+ *
+ * Reads never take a lock: the value lives in a std::atomic when T is lock-free
+ * (float, int) and behind a seqlock otherwise. Observers are an immutable,
+ * copy-on-write snapshot published through an atomic pointer, so notifying
+ * never waits for add_observer or remove_observer on another thread;
+ * replaced snapshots are freed once no notification is reading them.
+ *
+ * By default observers run on the writing thread and may run concurrently
+ * with each other, so they must be thread-safe themselves. With a
+ * DispatchQueue set, writes only enqueue the property and observers run on the
+ * thread draining the queue; any number of writes before a drain coalesce into
+ * one notification from the value last delivered to the latest value. An
+ * observer removed while a notification is running on another thread may
+ * still be called by it once. A property destroyed with a notification still
+ * queued withdraws it, but must not be destroyed while a drain() is running.
+ *
+ * @tparam T Trivially copyable value type
+ * @tparam ChangePolicy AlwaysNotify, NotifyOnChange or NotifyOutsideEpsilon
+ */
+template <typename T, typename ChangePolicy = AlwaysNotify>
+class AtomicProperty
+{
+    static_assert(std::is_trivially_copyable<T>::value, "AtomicProperty requires a trivially copyable type");
+
+public:
+    typedef InlineFunction<void(T, T)> Observer;
+
+private:
+    struct Entry
+    {
+        Observer observer;
+        uint32_t id;
+    };
+
+    typedef std::vector<Entry> Snapshot;
+
+    typename std::conditional<std::atomic<T>::is_always_lock_free, LockFreeValue<T>, SeqLockValue<T> >::type storage;
+
+    std::atomic<const Snapshot *> observers{nullptr};
+    // Notifications currently reading a snapshot
+    mutable std::atomic<uint32_t> readers{0};
+
+    // Guards publishing snapshots and the retired list, never taken by readers
+    std::mutex writer;
+    std::vector<const Snapshot *> retired;
+    uint32_t next_id = 1;
+
+    // Queued dispatch, see set_dispatch_queue
+    DispatchQueue *queue = nullptr;
+    std::atomic<bool> queued{false};
+    // Last value handed to observers by the draining thread, only touched there
+    T delivered;
+
+    static void deliver_queued(void *property)
+    {
+        AtomicProperty *self = static_cast<AtomicProperty *>(property);
+
+        // Clear first so a write racing with delivery queues itself again. As an
+        // RMW this synchronises with the last writer's exchange, so its value is seen.
+        self->queued.exchange(false, std::memory_order_acq_rel);
+        T current = self->load();
+
+        if (std::memcmp(&current, &self->delivered, sizeof(T)) == 0 ||
+            ChangePolicy::unchanged(self->delivered, current))
+        {
+            return;
+        }
+
+        T old = self->delivered;
+        self->delivered = current;
+        self->notify(old, current);
+    }
+
+    void publish(const Snapshot *next)
+    {
+        const Snapshot *previous = this->observers.exchange(next, std::memory_order_seq_cst);
+        if (previous)
+        {
+            this->retired.push_back(previous);
+        }
+
+        // Any notification starting after this point sees the new snapshot
+        if (this->readers.load(std::memory_order_seq_cst) == 0)
+        {
+            for (const Snapshot *snapshot : this->retired)
+            {
+                delete snapshot;
+            }
+            this->retired.clear();
+        }
+    }
+
+    void notify(T old, T current) const
+    {
+        this->readers.fetch_add(1, std::memory_order_seq_cst);
+        const Snapshot *snapshot = this->observers.load(std::memory_order_seq_cst);
+        if (snapshot)
+        {
+            for (const Entry &entry : *snapshot)
+            {
+                entry.observer(old, current);
+            }
+        }
+        this->readers.fetch_sub(1, std::memory_order_release);
+    }
+
+public:
+    explicit AtomicProperty(T initial = T()) : storage(initial), delivered(initial)
+    {
+    }
+
+    AtomicProperty(const AtomicProperty &) = delete;
+    AtomicProperty &operator=(const AtomicProperty &) = delete;
+
+    ~AtomicProperty()
+    {
+        if (this->queue && this->queued.load(std::memory_order_acquire))
+        {
+            this->queue->cancel(this);
+        }
+        delete this->observers.load(std::memory_order_relaxed);
+        for (const Snapshot *snapshot : this->retired)
+        {
+            delete snapshot;
+        }
+    }
+
+    /**
+     * @return T Current value, read without locking
+     */
+    T load() const
+    {
+        return this->storage.load();
+    }
+
+    operator T() const
+    {
+        return this->load();
+    }
+
+    /**
+     * @brief Routes notifications through a queue drained on another thread
+     *
+     * Set before the property is shared between threads.
+     *
+     * @param dispatch Queue that outlives the property, or nullptr to notify on the writing thread
+     */
+    void set_dispatch_queue(DispatchQueue *dispatch)
+    {
+        this->queue = dispatch;
+        this->delivered = this->load();
+    }
+
+    /**
+     * @brief Writes the value and notifies observers, or enqueues the notification
+     *
+     * @param new_value Value to write
+     */
+    void operator=(const T new_value)
+    {
+        T old;
+        if (!this->storage.template update<ChangePolicy>(new_value, old))
+        {
+            return;
+        }
+
+        if (!this->queue)
+        {
+            this->notify(old, new_value);
+            return;
+        }
+
+        // Already queued writes coalesce into the pending notification
+        if (!this->queued.exchange(true, std::memory_order_seq_cst))
+        {
+            if (!this->queue->push(DispatchQueue::Notification{this, &AtomicProperty::deliver_queued}))
+            {
+                // Let the next write retry
+                this->queued.store(false, std::memory_order_relaxed);
+            }
+        }
+#if OBSERVER_INSTRUMENTATION
+        else
+        {
+            AnimationStats::add_cross_thread_coalesced();
+        }
+#endif
+    }
+
+    /**
+     * @brief Observer will be called in the event that the backing value changes
+     *
+     * @param observer Thread-safe callable
+     * @return ObserverHandle Handle for remove_observer
+     */
+    template <typename F>
+    ObserverHandle add_observer(F observer)
+    {
+        std::lock_guard<std::mutex> lock(this->writer);
+
+        const Snapshot *current = this->observers.load(std::memory_order_relaxed);
+        Snapshot *next = current ? new Snapshot(*current) : new Snapshot();
+        uint32_t id = this->next_id++;
+        next->push_back(Entry{Observer(std::move(observer)), id});
+
+        this->publish(next);
+        return ObserverHandle{id, 1};
+    }
+
+    /**
+     * @brief Stops an observer from being called
+     *
+     * @param handle Handle returned by add_observer
+     * @return true The observer was removed
+     */
+    bool remove_observer(ObserverHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(this->writer);
+
+        const Snapshot *current = this->observers.load(std::memory_order_relaxed);
+        if (!current)
+        {
+            return false;
+        }
+
+        Snapshot *next = new Snapshot();
+        next->reserve(current->size());
+        for (const Entry &entry : *current)
+        {
+            if (entry.id != handle.slot)
+            {
+                next->push_back(entry);
+            }
+        }
+
+        if (next->size() == current->size())
+        {
+            delete next;
+            return false;
+        }
+        this->publish(next);
+        return true;
+    }
+};
+
+#if OBSERVER_EXTERN_TEMPLATES
+extern template class AtomicProperty<float>;
+extern template class AtomicProperty<int>;
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "animation_pool.h"
+
+class AnimationWorkerPool;
+
+/**
+ * @brief Type-erased collection of animations sharing one concrete type
+ *
+ * The scheduler advances every batch once per frame, so the virtual call is
+ * paid once per animation type rather than once per animation.
+ */
+class AnimationBatch
+{
+public:
+    virtual ~AnimationBatch() = default;
+
+    /**
+     * @brief Advances every animation in the batch and retires finished ones
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     */
+    virtual void tick(int64_t now) = 0;
+
+    /**
+     * @return size_t Number of animations still in flight
+     */
+    virtual size_t size() const = 0;
+
+    /**
+     * @brief Lets the batch spread its evaluation over a worker pool
+     *
+     * @param pool Pool to use, or nullptr to evaluate on the calling thread
+     */
+    virtual void set_workers(AnimationWorkerPool *)
+    {
+    }
+
+    // Animations retired by the last tick
+    size_t completed = 0;
+    // Animations, such as paused groups, that reported themselves idle on the last tick
+    size_t idle = 0;
+};
+
+template <typename A>
+class TypedAnimationBatch : public AnimationBatch
+{
+public:
+    AnimationPool<A> animations;
+
+    void tick(int64_t now) override
+    {
+        this->completed = 0;
+        this->idle = 0;
+
+        // Walk a snapshot of the handles: a callback such as on_update may
+        // cancel or replace any animation, including the one being advanced,
+        // and the pass keeps released animations intact until it ends
+        this->pass.clear();
+        for (size_t i = 0; i < this->animations.size(); i++)
+        {
+            this->pass.push_back(this->animations.live_handle(i));
+        }
+
+        this->animations.begin_pass();
+        for (AnimationHandle handle : this->pass)
+        {
+            A *animation = this->animations.get(handle);
+            if (!animation)
+            {
+                continue;
+            }
+            auto step = animation->advance(now);
+            if (step.completed)
+            {
+                // Already released if a callback cancelled it
+                if (this->animations.release(handle))
+                {
+                    this->completed++;
+                }
+            }
+            else if (step.idle)
+            {
+                this->idle++;
+            }
+        }
+        this->animations.end_pass();
+    }
+
+    size_t size() const override
+    {
+        return this->animations.size();
+    }
+
+private:
+    // Handles being advanced by the current tick, kept to reuse its capacity
+    std::vector<AnimationHandle> pass;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <unordered_map>
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OBSERVER_HAS_MMAP 1
+#else
+#define OBSERVER_HAS_MMAP 0
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::system_clock;
+
+// When set, the extern template declarations at the end of the observer headers
+// suppress implicit instantiation of the most used specialisations.
+// They are instantiated once in animation.cpp, which the observer library target
+// builds and which sets this for everything linking against it
+#ifndef OBSERVER_EXTERN_TEMPLATES
+#define OBSERVER_EXTERN_TEMPLATES 0
+#endif
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "animation.h"
+#include "geometry.h"
+
+/**
+ * @brief Up to four animated components of an aggregate, packed for a 4-lane lerp
+ */
+struct alignas(16) AnimationVector
+{
+    float lanes[4];
+};
+
+/**
+ * @brief Lerps all four lanes of two vectors at once
+ *
+ * @param start Values at progress 0
+ * @param end Values at progress 1
+ * @param prog Eased progress
+ * @return AnimationVector Interpolated lanes
+ */
+inline AnimationVector lerp4(const AnimationVector &start, const AnimationVector &end, float prog)
+{
+    AnimationVector result;
+#if defined(__SSE2__)
+    __m128 s = _mm_load_ps(start.lanes);
+    __m128 e = _mm_load_ps(end.lanes);
+    _mm_store_ps(result.lanes, _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(prog), _mm_sub_ps(e, s))));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t s = vld1q_f32(start.lanes);
+    float32x4_t e = vld1q_f32(end.lanes);
+    vst1q_f32(result.lanes, vmlaq_n_f32(s, vsubq_f32(e, s), prog));
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        result.lanes[i] = start.lanes[i] + prog * (end.lanes[i] - start.lanes[i]);
+    }
+#endif
+    return result;
+}
+
+/**
+ * @brief AnimationVector interpolates through lerp4
+ */
+template <>
+struct LerpTraits<AnimationVector>
+{
+    static AnimationVector lerp(const AnimationVector &start, const AnimationVector &end, float prog)
+    {
+        return lerp4(start, end, prog);
+    }
+};
+
+/**
+ * @brief Maps an aggregate of properties onto one interpolatable value
+ *
+ * Specialise for aggregates that should be animatable with CompositeAnimation.
+ * Value is the packed form the animation interpolates, an AnimationVector or
+ * any other type with a LerpTraits specialisation. read() captures the current
+ * values and write() stores them without calling observers.
+ *
+ * @tparam A Aggregate type such as Point or Rect
+ */
+template <typename A>
+struct AggregateTraits;
+
+template <>
+struct AggregateTraits<Point>
+{
+    typedef AnimationVector Value;
+
+    static AnimationVector read(const Point &point)
+    {
+        return AnimationVector{{point.x.value, point.y.value, 0.0f, 0.0f}};
+    }
+
+    static void write(Point &point, const AnimationVector &v)
+    {
+        point.x.store(v.lanes[0]);
+        point.y.store(v.lanes[1]);
+    }
+};
+
+template <>
+struct AggregateTraits<Size>
+{
+    typedef AnimationVector Value;
+
+    static AnimationVector read(const Size &size)
+    {
+        return AnimationVector{{size.width.value, size.height.value, 0.0f, 0.0f}};
+    }
+
+    static void write(Size &size, const AnimationVector &v)
+    {
+        size.width.store(v.lanes[0]);
+        size.height.store(v.lanes[1]);
+    }
+};
+
+template <>
+struct AggregateTraits<Rect>
+{
+    typedef AnimationVector Value;
+
+    static AnimationVector read(const Rect &rect)
+    {
+        return AnimationVector{{rect.position.x.value, rect.position.y.value, rect.size.width.value,
+                                rect.size.height.value}};
+    }
+
+    static void write(Rect &rect, const AnimationVector &v)
+    {
+        rect.position.x.store(v.lanes[0]);
+        rect.position.y.store(v.lanes[1]);
+        rect.size.width.store(v.lanes[2]);
+        rect.size.height.store(v.lanes[3]);
+    }
+};
+
+/**
+ * @brief Colors animate as RGBA8, all channels in one integer lerp with no float round trip
+ *
+ * Channels are clamped to [0, 255] when read, so a channel outside that range
+ * jumps into it on the first frame, even one whose start and end agree. Animate
+ * such channels one by one as Animation<int>, which keeps the full int range.
+ */
+template <>
+struct AggregateTraits<Color>
+{
+    typedef RGBA8 Value;
+
+    static RGBA8 read(const Color &color)
+    {
+        return RGBA8::make((uint8_t)std::min(std::max(color.r.value, 0), 255),
+                           (uint8_t)std::min(std::max(color.g.value, 0), 255),
+                           (uint8_t)std::min(std::max(color.b.value, 0), 255));
+    }
+
+    static void write(Color &color, RGBA8 value)
+    {
+        color.r.store(value.r());
+        color.g.store(value.g());
+        color.b.store(value.b());
+    }
+};
+
+/**
+ * @brief Animates every component of an aggregate along one shared timeline
+ *
+ * A Rect animation is one timing evaluation and one 4-lane lerp per frame
+ * rather than four independent animations, and a Color one is a single RGBA8
+ * lerp. Components are written without
+ * per-property notification; on_update, if set, is the single coalesced
+ * notification for the whole aggregate and runs after all of them are written.
+ *
+ * @tparam A Aggregate with an AggregateTraits specialisation
+ * @tparam Easing Curve type with a static apply(t), see Linear
+ */
+template <typename A, typename Easing>
+class CompositeAnimation
+{
+public:
+    typedef typename AggregateTraits<A>::Value Value;
+
+private:
+    int64_t start_time = 0;
+    double inv_duration = 0.0;
+
+public:
+    A *target;
+    Value start;
+    Value end;
+
+    // In milliseconds
+    int64_t duration;
+
+    // Called once per frame after every component has been written
+    InlineFunction<void(A &)> on_update;
+
+    /**
+     * @brief Captures the target's current values as the start of the animation
+     */
+    void start_from_current()
+    {
+        this->start = AggregateTraits<A>::read(*this->target);
+    }
+
+    /**
+     * @brief Starts the animation at AnimationCore::start_time()
+     */
+    void prep()
+    {
+        this->prep(AnimationCore::start_time());
+    }
+
+    /**
+     * @param now Start time in microseconds since the steady_clock epoch
+     */
+    void prep(int64_t now)
+    {
+        this->start_time = now;
+        this->inv_duration = 1.0 / ((double)std::max<int64_t>(this->duration, 1) * 1000.0);
+    }
+
+    /**
+     * @brief Progresses every component and reports completion, in one evaluation
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     * @return AnimationStep<Value> Value written to the target and completion status
+     */
+    AnimationStep<Value> advance(int64_t now)
+    {
+        float prog = (float)((double)(now - this->start_time) * this->inv_duration);
+        AnimationStep<Value> step;
+
+        step.completed = prog >= 1.0f;
+        if (step.completed)
+        {
+            step.value = this->end;
+        }
+        else
+        {
+            step.value = lerp(this->start, this->end, Easing::apply(std::max(prog, 0.0f)));
+        }
+
+        AggregateTraits<A>::write(*this->target, step.value);
+        if (this->on_update)
+        {
+            this->on_update(*this->target);
+        }
+        return step;
+    }
+};
@@ -0,0 +1,304 @@
+#pragma once
+
+#include "property.h"
+
+/**
+ * @brief Node in the graph of computed properties, see ComputedProperty
+ *
+ * An input change marks its dependents dirty synchronously, so a read never
+ * sees a stale value. Nodes with observers are also queued and republished
+ * later in rank order (inputs before dependents), once per change, so a
+ * diamond of dependencies notifies each node once with consistent values.
+ */
+class ComputedNode
+{
+protected:
+    // One more than the highest rank among the computed inputs, 0 for plain inputs only
+    uint32_t rank = 0;
+    bool dirty = true;
+    bool scheduled = false;
+    std::vector<ComputedNode *> dependents;
+    std::vector<ComputedNode *> upstream;
+
+    virtual ~ComputedNode() = default;
+
+    // Recomputes the value if dirty, without notifying
+    virtual void settle() = 0;
+    // Settles and notifies observers if the value changed since they last saw it
+    virtual void publish() = 0;
+    virtual bool observed() const = 0;
+
+    static std::vector<ComputedNode *> &pending()
+    {
+        static thread_local std::vector<ComputedNode *> value;
+        return value;
+    }
+
+    static bool &publishing()
+    {
+        static thread_local bool value = false;
+        return value;
+    }
+
+    static bool &flush_queued()
+    {
+        static thread_local bool value = false;
+        return value;
+    }
+
+    void depend_on(ComputedNode *input)
+    {
+        input->dependents.push_back(this);
+        this->upstream.push_back(input);
+        this->rank = std::max(this->rank, input->rank + 1);
+    }
+
+    void settle_upstream()
+    {
+        for (ComputedNode *input : this->upstream)
+        {
+            input->settle();
+        }
+    }
+
+    void detach()
+    {
+        for (ComputedNode *input : this->upstream)
+        {
+            auto &list = input->dependents;
+            list.erase(std::remove(list.begin(), list.end(), this), list.end());
+        }
+        if (this->scheduled)
+        {
+            auto &list = pending();
+            list.erase(std::remove(list.begin(), list.end(), this), list.end());
+        }
+    }
+
+    void mark()
+    {
+        if (this->dirty)
+        {
+            // Already marked, and so are its dependents
+            return;
+        }
+
+        this->dirty = true;
+        if (this->observed() && !this->scheduled)
+        {
+            this->scheduled = true;
+            pending().push_back(this);
+        }
+        for (ComputedNode *dependent : this->dependents)
+        {
+            dependent->mark();
+        }
+    }
+
+    /**
+     * @brief Called when one of the node's inputs changes
+     */
+    void invalidate()
+    {
+        this->mark();
+        if (pending().empty() || publishing())
+        {
+            return;
+        }
+
+        // Wait until the triggering write has been stored, or the batch's other writes have landed
+        if (PropertyBatch::deferring())
+        {
+            if (!flush_queued())
+            {
+                flush_queued() = true;
+                PropertyBatch::enqueue(nullptr, &ComputedNode::flush_thunk);
+            }
+            return;
+        }
+
+        flush();
+    }
+
+    static void invalidate_thunk(void *node)
+    {
+        static_cast<ComputedNode *>(node)->invalidate();
+    }
+
+    static void flush_thunk(void *)
+    {
+        flush_queued() = false;
+        flush();
+    }
+
+    static void flush()
+    {
+        publishing() = true;
+        std::vector<ComputedNode *> round;
+        while (!pending().empty())
+        {
+            round.clear();
+            round.swap(pending());
+            std::stable_sort(round.begin(), round.end(),
+                             [](ComputedNode *a, ComputedNode *b)
+                             { return a->rank < b->rank; });
+
+            for (ComputedNode *node : round)
+            {
+                node->scheduled = false;
+                node->publish();
+            }
+        }
+        publishing() = false;
+    }
+};
+
+/**
+ * @brief Read-only value derived from other properties, recomputed lazily
+ *
+ * Inputs are ObservableProperty instances in any mode or other
+ * ComputedProperty instances, and must outlive the computed property. Every
+ * stored write to an input, including animation and batched writes, only marks
+ * the value dirty; it is recomputed on the next get(), after its computed
+ * inputs have been settled. Several input writes inside a PropertyBatch
+ * therefore cost one recomputation at commit.
+ *
+ *     ComputedProperty<float> right(
+ *         [&view] { return view.frame.position.x.value + view.frame.size.width.value; },
+ *         view.frame.position.x, view.frame.size.width);
+ *
+ * Neither copyable nor movable, its inputs hold pointers to it.
+ *
+ * @tparam T Value type
+ * @tparam ChangePolicy Decides whether a recomputed value notifies, NotifyOnChange by default
+ */
+template <typename T, typename ChangePolicy = NotifyOnChange>
+class ComputedProperty : public ComputedNode
+{
+private:
+    InlineFunction<T()> compute;
+    T cached;
+    // Value observers were last notified with
+    T published;
+    ObserverList<T> observers;
+    std::vector<PropertyDependents *> inputs;
+
+    template <typename U, typename Policy>
+    void add_input(ObservableProperty<U, Policy> &input)
+    {
+        input.dependents.add(static_cast<ComputedNode *>(this), &ComputedNode::invalidate_thunk);
+        this->inputs.push_back(&input.dependents);
+    }
+
+    template <typename U, typename Policy>
+    void add_input(ComputedProperty<U, Policy> &input)
+    {
+        this->depend_on(&input);
+    }
+
+    void settle() override
+    {
+        if (!this->dirty)
+        {
+            return;
+        }
+
+        // Inputs first, so the value is computed from a consistent state
+        this->settle_upstream();
+        this->cached = this->compute();
+        this->dirty = false;
+    }
+
+    void publish() override
+    {
+        this->settle();
+        if (!ChangePolicy::unchanged(this->published, this->cached))
+        {
+            T old = this->published;
+            this->published = this->cached;
+            this->observers.notify(old, this->cached);
+        }
+    }
+
+    bool observed() const override
+    {
+        return !this->observers.empty();
+    }
+
+public:
+    /**
+     * @param compute Callable returning the value from the inputs' current values
+     * @param inputs ObservableProperty or ComputedProperty instances compute reads
+     */
+    template <typename F, typename... Inputs>
+    explicit ComputedProperty(F compute, Inputs &...inputs) : compute(std::move(compute))
+    {
+        (this->add_input(inputs), ...);
+        this->cached = this->compute();
+        this->published = this->cached;
+        this->dirty = false;
+    }
+
+    ComputedProperty(const ComputedProperty &) = delete;
+    ComputedProperty &operator=(const ComputedProperty &) = delete;
+
+    ~ComputedProperty() override
+    {
+        for (PropertyDependents *input : this->inputs)
+        {
+            input->remove(static_cast<ComputedNode *>(this));
+        }
+        this->detach();
+    }
+
+    /**
+     * @return const T& Current value, recomputed first if an input changed
+     */
+    const T &get()
+    {
+        this->settle();
+        return this->cached;
+    }
+
+    /**
+     * @return true An input changed since the value was last computed
+     */
+    bool is_dirty() const
+    {
+        return this->dirty;
+    }
+
+    /**
+     * @brief Observer will be called when the recomputed value changes
+     *
+     * Observers run after the triggering write, or at commit inside a batch,
+     * never once per input.
+     *
+     * @param observer Lambda to be called
+     * @return ObserverHandle Handle for remove_observer
+     */
+    template <typename F>
+    ObserverHandle add_observer(F observer)
+    {
+        // Observers must see changes relative to the current value
+        this->published = this->get();
+        return this->observers.add(std::move(observer));
+    }
+
+    bool remove_observer(ObserverHandle handle)
+    {
+        return this->observers.remove(handle);
+    }
+
+    template <typename F>
+    Subscription subscribe(F observer)
+    {
+        ObserverHandle handle = this->add_observer(std::move(observer));
+        return Subscription(&this->observers, &ObserverList<T>::remove_thunk, handle);
+    }
+};
+
+#if OBSERVER_EXTERN_TEMPLATES
+extern template class ComputedProperty<float>;
+extern template class ComputedProperty<int>;
+#endif
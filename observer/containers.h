@@ -0,0 +1,506 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * @brief Type-erased callable that is stored in place when it fits
+ *
+ * Stands in for std::function on the observer path. Captureless lambdas and
+ * lambdas capturing up to Capacity bytes never touch the heap; anything
+ * larger falls back to a single heap allocation.
+ *
+ * @tparam Signature Function signature, for example void(float, float)
+ * @tparam Capacity Bytes of inline storage for the callable
+ */
+template <typename Signature, size_t Capacity = 2 * sizeof(void *)>
+class InlineFunction;
+
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity>
+{
+private:
+    enum class Op
+    {
+        Copy,
+        Move,
+        Destroy
+    };
+
+    static constexpr size_t Alignment = alignof(void *) > alignof(double) ? alignof(void *) : alignof(double);
+
+    alignas(Alignment) unsigned char storage[Capacity];
+    R (*invoker)(void *, Args...) = nullptr;
+    void (*manager)(Op, void *, void *) = nullptr;
+
+    template <typename F>
+    static constexpr bool fits_inline()
+    {
+        return sizeof(F) <= Capacity && alignof(F) <= Alignment &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    template <typename F>
+    static R invoke_inline(void *callable, Args... args)
+    {
+        return (*static_cast<F *>(callable))(std::forward<Args>(args)...);
+    }
+
+    template <typename F>
+    static void manage_inline(Op op, void *dst, void *src)
+    {
+        switch (op)
+        {
+        case Op::Copy:
+            new (dst) F(*static_cast<const F *>(src));
+            break;
+        case Op::Move:
+            new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+            break;
+        case Op::Destroy:
+            static_cast<F *>(dst)->~F();
+            break;
+        }
+    }
+
+    template <typename F>
+    static R invoke_heap(void *callable, Args... args)
+    {
+        return (**static_cast<F **>(callable))(std::forward<Args>(args)...);
+    }
+
+    template <typename F>
+    static void manage_heap(Op op, void *dst, void *src)
+    {
+        switch (op)
+        {
+        case Op::Copy:
+            *static_cast<F **>(dst) = new F(**static_cast<F **>(src));
+            break;
+        case Op::Move:
+            *static_cast<F **>(dst) = *static_cast<F **>(src);
+            break;
+        case Op::Destroy:
+            delete *static_cast<F **>(dst);
+            break;
+        }
+    }
+
+    void reset()
+    {
+        if (this->manager)
+        {
+            this->manager(Op::Destroy, this->storage, nullptr);
+        }
+        this->invoker = nullptr;
+        this->manager = nullptr;
+    }
+
+public:
+    InlineFunction() = default;
+
+    template <typename F, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+    InlineFunction(F &&callable)
+    {
+        typedef typename std::decay<F>::type Callable;
+
+        if constexpr (fits_inline<Callable>())
+        {
+            new (this->storage) Callable(std::forward<F>(callable));
+            this->invoker = &invoke_inline<Callable>;
+            this->manager = &manage_inline<Callable>;
+        }
+        else
+        {
+            *reinterpret_cast<Callable **>(this->storage) = new Callable(std::forward<F>(callable));
+            this->invoker = &invoke_heap<Callable>;
+            this->manager = &manage_heap<Callable>;
+        }
+    }
+
+    InlineFunction(const InlineFunction &other) : invoker(other.invoker), manager(other.manager)
+    {
+        if (this->manager)
+        {
+            this->manager(Op::Copy, this->storage, const_cast<unsigned char *>(other.storage));
+        }
+    }
+
+    InlineFunction(InlineFunction &&other) noexcept : invoker(other.invoker), manager(other.manager)
+    {
+        if (this->manager)
+        {
+            this->manager(Op::Move, this->storage, other.storage);
+        }
+        other.invoker = nullptr;
+        other.manager = nullptr;
+    }
+
+    InlineFunction &operator=(const InlineFunction &other)
+    {
+        if (this != &other)
+        {
+            InlineFunction copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    InlineFunction &operator=(InlineFunction &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->reset();
+            this->invoker = other.invoker;
+            this->manager = other.manager;
+            if (this->manager)
+            {
+                this->manager(Op::Move, this->storage, other.storage);
+            }
+            other.invoker = nullptr;
+            other.manager = nullptr;
+        }
+        return *this;
+    }
+
+    ~InlineFunction()
+    {
+        this->reset();
+    }
+
+    explicit operator bool() const
+    {
+        return this->invoker != nullptr;
+    }
+
+    R operator()(Args... args) const
+    {
+        return this->invoker(const_cast<unsigned char *>(this->storage), std::forward<Args>(args)...);
+    }
+};
+
+/**
+ * @brief Vector that keeps its first N elements inside the object
+ *
+ * Only grows onto the heap once more than N elements are stored, so the common
+ * case of one or two entries costs no allocation at all.
+ *
+ * @tparam T Element type
+ * @tparam N Number of elements stored in place, at least 1
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+private:
+    static_assert(N > 0, "SmallVector needs at least one inline element");
+
+    alignas(T) unsigned char inline_storage[N * sizeof(T)];
+    T *items;
+    uint32_t count = 0;
+    uint32_t capacity = N;
+
+    bool is_inline() const
+    {
+        return this->items == reinterpret_cast<const T *>(this->inline_storage);
+    }
+
+    void grow(size_t min_capacity)
+    {
+        size_t new_capacity = std::max<size_t>(min_capacity, (size_t)this->capacity * 2);
+        T *heap = static_cast<T *>(::operator new(new_capacity * sizeof(T)));
+
+        for (uint32_t i = 0; i < this->count; i++)
+        {
+            new (heap + i) T(std::move(this->items[i]));
+            this->items[i].~T();
+        }
+        if (!this->is_inline())
+        {
+            ::operator delete(this->items);
+        }
+
+        this->items = heap;
+        this->capacity = (uint32_t)new_capacity;
+    }
+
+    void release()
+    {
+        this->clear();
+        if (!this->is_inline())
+        {
+            ::operator delete(this->items);
+        }
+        this->items = reinterpret_cast<T *>(this->inline_storage);
+        this->capacity = N;
+    }
+
+    void take(SmallVector &&other)
+    {
+        if (other.is_inline())
+        {
+            for (uint32_t i = 0; i < other.count; i++)
+            {
+                new (this->items + i) T(std::move(other.items[i]));
+            }
+            this->count = other.count;
+            other.clear();
+        }
+        else
+        {
+            this->items = other.items;
+            this->count = other.count;
+            this->capacity = other.capacity;
+            other.items = reinterpret_cast<T *>(other.inline_storage);
+            other.count = 0;
+            other.capacity = N;
+        }
+    }
+
+public:
+    SmallVector() : items(reinterpret_cast<T *>(inline_storage))
+    {
+    }
+
+    SmallVector(const SmallVector &other) : SmallVector()
+    {
+        *this = other;
+    }
+
+    SmallVector(SmallVector &&other) noexcept : SmallVector()
+    {
+        this->take(std::move(other));
+    }
+
+    SmallVector &operator=(const SmallVector &other)
+    {
+        if (this != &other)
+        {
+            this->clear();
+            this->reserve(other.count);
+            for (const T &item : other)
+            {
+                this->push_back(item);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->release();
+            this->take(std::move(other));
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        this->release();
+    }
+
+    void reserve(size_t new_capacity)
+    {
+        if (new_capacity > this->capacity)
+        {
+            this->grow(new_capacity);
+        }
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args)
+    {
+        if (this->count == this->capacity)
+        {
+            // Build first, the arguments may refer to an element being moved
+            T item(std::forward<Args>(args)...);
+            this->grow(this->count + 1);
+            return *new (this->items + this->count++) T(std::move(item));
+        }
+        return *new (this->items + this->count++) T(std::forward<Args>(args)...);
+    }
+
+    void push_back(const T &item)
+    {
+        this->emplace_back(item);
+    }
+
+    void push_back(T &&item)
+    {
+        this->emplace_back(std::move(item));
+    }
+
+    void pop_back()
+    {
+        this->items[--this->count].~T();
+    }
+
+    void clear()
+    {
+        while (this->count > 0)
+        {
+            this->pop_back();
+        }
+    }
+
+    size_t size() const
+    {
+        return this->count;
+    }
+
+    bool empty() const
+    {
+        return this->count == 0;
+    }
+
+    T &operator[](size_t index)
+    {
+        return this->items[index];
+    }
+
+    const T &operator[](size_t index) const
+    {
+        return this->items[index];
+    }
+
+    T &back()
+    {
+        return this->items[this->count - 1];
+    }
+
+    T *begin()
+    {
+        return this->items;
+    }
+
+    T *end()
+    {
+        return this->items + this->count;
+    }
+
+    const T *begin() const
+    {
+        return this->items;
+    }
+
+    const T *end() const
+    {
+        return this->items + this->count;
+    }
+};
+
+/**
+ * @brief Bounded lock-free ring with many producers and one consumer
+ *
+ * Every cell carries a sequence number telling producers whether it is free
+ * and the consumer whether it has been filled, so push never locks and never
+ * waits for the consumer. A full ring rejects the push instead of blocking.
+ *
+ * @tparam T Trivially copyable element type
+ */
+template <typename T>
+class MpscRing
+{
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "MpscRing copies elements in and out of its cells");
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> enqueue_position{0};
+    alignas(64) size_t dequeue_position = 0;
+
+public:
+    /**
+     * @param capacity Maximum elements held, rounded up to a power of two
+     */
+    explicit MpscRing(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        this->cells.reset(new Cell[size]);
+        this->mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+        {
+            this->cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+
+    /**
+     * @brief Appends an element, callable from any thread
+     *
+     * @param item Element to copy in
+     * @return true Enqueued
+     * @return false The ring was full and item was not stored
+     */
+    bool push(const T &item)
+    {
+        size_t position = this->enqueue_position.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = this->cells[position & this->mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+            if (difference == 0)
+            {
+                if (this->enqueue_position.compare_exchange_weak(position, position + 1,
+                                                                 std::memory_order_relaxed))
+                {
+                    cell.item = item;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = this->enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the oldest element, call from the single consumer only
+     *
+     * @param item Receives the element
+     * @return true An element was removed
+     * @return false The ring was empty, or its oldest element is still being written
+     */
+    bool pop(T &item)
+    {
+        Cell &cell = this->cells[this->dequeue_position & this->mask];
+        if (cell.sequence.load(std::memory_order_acquire) != this->dequeue_position + 1)
+        {
+            return false;
+        }
+
+        item = cell.item;
+        cell.sequence.store(this->dequeue_position + this->mask + 1, std::memory_order_release);
+        this->dequeue_position++;
+        return true;
+    }
+
+    size_t capacity() const
+    {
+        return this->mask + 1;
+    }
+};
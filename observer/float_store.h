@@ -0,0 +1,496 @@
+#pragma once
+
+#include "animation.h"
+#include "batch.h"
+#include "worker_pool.h"
+
+/**
+ * @brief Evaluates a block of float animations stored as parallel arrays
+ *
+ * Computes progress for every lane as elapsed time times the precomputed
+ * inverse duration, clamps it to [0, 1] and lerps between start and end. The
+ * velocity term adds velocity[i] * p * (1 - p)^2, which is zero at both ends
+ * and lets a retargeted lane start with the slope it had before. Lanes are
+ * processed 8 at a time with AVX2 or NEON when available and with a scalar
+ * loop otherwise.
+ *
+ * @param start Start values
+ * @param end End values
+ * @param velocity Velocity blend coefficients, 0 for a plain lerp
+ * @param start_time Start times in ms relative to the store epoch, fractional
+ * @param inv_duration Reciprocal of each duration in ms
+ * @param now Current time in ms relative to the store epoch, fractional
+ * @param values Output interpolated values
+ * @param done Output bitmask, bit (i % 8) of done[i / 8] is set once lane i has finished
+ * @param count Number of lanes
+ */
+inline void lerp_kernel(const float *start, const float *end, const float *velocity, const float *start_time,
+                        const float *inv_duration, float now, float *values, uint8_t *done, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 now_v = _mm256_set1_ps(now);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 s = _mm256_loadu_ps(start + i);
+        __m256 e = _mm256_loadu_ps(end + i);
+        __m256 elapsed = _mm256_sub_ps(now_v, _mm256_loadu_ps(start_time + i));
+
+        __m256 raw = _mm256_mul_ps(elapsed, _mm256_loadu_ps(inv_duration + i));
+        __m256 prog = _mm256_min_ps(_mm256_max_ps(raw, zero), one);
+
+        __m256 rest = _mm256_sub_ps(one, prog);
+        __m256 bump = _mm256_mul_ps(_mm256_mul_ps(prog, rest), rest);
+        __m256 value = _mm256_add_ps(s, _mm256_mul_ps(prog, _mm256_sub_ps(e, s)));
+        value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_loadu_ps(velocity + i), bump));
+
+        _mm256_storeu_ps(values + i, value);
+        done[i / 8] = (uint8_t)_mm256_movemask_ps(_mm256_cmp_ps(raw, one, _CMP_GE_OQ));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t now_v = vdupq_n_f32(now);
+    const uint32_t lane_bits_init[4] = {1, 2, 4, 8};
+    const uint32x4_t lane_bits = vld1q_u32(lane_bits_init);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        uint32_t mask = 0;
+        for (size_t half = 0; half < 8; half += 4)
+        {
+            float32x4_t s = vld1q_f32(start + i + half);
+            float32x4_t e = vld1q_f32(end + i + half);
+            float32x4_t elapsed = vsubq_f32(now_v, vld1q_f32(start_time + i + half));
+
+            float32x4_t raw = vmulq_f32(elapsed, vld1q_f32(inv_duration + i + half));
+            float32x4_t prog = vminq_f32(vmaxq_f32(raw, zero), one);
+
+            float32x4_t rest = vsubq_f32(one, prog);
+            float32x4_t bump = vmulq_f32(vmulq_f32(prog, rest), rest);
+            float32x4_t value = vaddq_f32(s, vmulq_f32(prog, vsubq_f32(e, s)));
+            value = vaddq_f32(value, vmulq_f32(vld1q_f32(velocity + i + half), bump));
+
+            vst1q_f32(values + i + half, value);
+            mask |= vaddvq_u32(vandq_u32(vcgeq_f32(raw, one), lane_bits)) << half;
+        }
+        done[i / 8] = (uint8_t)mask;
+    }
+#endif
+
+    // Scalar tail, or the whole range when no vector unit is available
+    for (; i < count; i++)
+    {
+        float raw = (now - start_time[i]) * inv_duration[i];
+        float prog = std::min(std::max(raw, 0.0f), 1.0f);
+        float rest = 1.0f - prog;
+        values[i] = start[i] + prog * (end[i] - start[i]) + velocity[i] * (prog * rest * rest);
+
+        uint8_t bit = (uint8_t)(1u << (i % 8));
+        if (i % 8 == 0)
+        {
+            done[i / 8] = 0;
+        }
+        if (raw >= 1.0f)
+        {
+            done[i / 8] |= bit;
+        }
+    }
+}
+
+/**
+ * @brief Portable state of one FloatAnimationStore lane, with times relative to a given now
+ */
+struct FloatLaneState
+{
+    ObservableProperty<float> *property;
+    float start;
+    float end;
+    float velocity;
+    // Time since the lane started, in ms
+    float elapsed;
+    // 1 / duration in ms
+    float inv_duration;
+};
+
+/**
+ * @brief Structure-of-arrays storage for float animations
+ *
+ * Each animation is a lane across contiguous start, end, start time and
+ * inverse duration arrays so a frame is one vectorised pass followed by a
+ * write back to the target properties, with lanes that completed on that pass
+ * retired immediately. Times are kept as fractional float ms relative to a
+ * microsecond epoch that is reset whenever the store drains and moved forward
+ * every REBASE_MS while it never does, which keeps them within a few
+ * microseconds of precision however long the store stays busy.
+ *
+ * Each property has at most one lane. Adding an animation for a property that
+ * is already animating retargets its lane instead: the new segment starts from
+ * the in-flight value and velocity, so rapid writes such as drag gestures
+ * never stack up competing animations.
+ */
+class FloatAnimationStore : public AnimationBatch
+{
+private:
+    int64_t epoch = 0;
+
+    std::vector<float> start;
+    std::vector<float> end;
+    std::vector<float> velocity;
+    std::vector<float> start_time;
+    std::vector<float> inv_duration;
+    std::vector<ObservableProperty<float> *> properties;
+
+    // Lane currently animating each property
+    std::unordered_map<const ObservableProperty<float> *, uint32_t> lanes;
+
+    // Per-frame scratch, kept around to avoid reallocating every frame
+    std::vector<float> values;
+    std::vector<uint8_t> done;
+
+    // Lanes per parallel chunk, a multiple of 8 so chunks never share a done byte
+    static constexpr size_t CHUNK_LANES = 4096;
+
+    // Frame time past which the epoch moves forward, float ms still resolve 4 us here
+    static constexpr int64_t REBASE_MS = 60000;
+
+    AnimationWorkerPool *workers = nullptr;
+    float frame_now = 0.0f;
+
+    void evaluate(size_t first, size_t count)
+    {
+        lerp_kernel(this->start.data() + first, this->end.data() + first, this->velocity.data() + first,
+                    this->start_time.data() + first, this->inv_duration.data() + first, this->frame_now,
+                    this->values.data() + first, this->done.data() + first / 8, count);
+    }
+
+    /**
+     * @brief Moves the epoch forward to a whole millisecond close to now, shifting every start time
+     *
+     * @param now Current time in microseconds
+     */
+    void rebase(int64_t now)
+    {
+        int64_t shift_ms = (now - this->epoch) / 1000;
+        this->epoch += shift_ms * 1000;
+
+        // Start times and the shift are both on the float grid here, so the difference is exact
+        float shift = (float)shift_ms;
+        for (float &started : this->start_time)
+        {
+            started -= shift;
+        }
+    }
+
+    static void evaluate_chunk(void *store, size_t chunk)
+    {
+        FloatAnimationStore *self = static_cast<FloatAnimationStore *>(store);
+        size_t first = chunk * CHUNK_LANES;
+        self->evaluate(first, std::min(CHUNK_LANES, self->properties.size() - first));
+    }
+
+    void remove(size_t lane)
+    {
+        size_t last = this->properties.size() - 1;
+        this->lanes.erase(this->properties[lane]);
+        if (lane != last)
+        {
+            this->start[lane] = this->start[last];
+            this->end[lane] = this->end[last];
+            this->velocity[lane] = this->velocity[last];
+            this->start_time[lane] = this->start_time[last];
+            this->inv_duration[lane] = this->inv_duration[last];
+            this->properties[lane] = this->properties[last];
+            this->lanes[this->properties[lane]] = (uint32_t)lane;
+        }
+        this->start.pop_back();
+        this->end.pop_back();
+        this->velocity.pop_back();
+        this->start_time.pop_back();
+        this->inv_duration.pop_back();
+        this->properties.pop_back();
+    }
+
+    /**
+     * @brief Evaluates one lane and its slope at a time, on the calling thread
+     *
+     * @param lane Lane to evaluate
+     * @param now Time in ms relative to the epoch
+     * @param value Receives the value
+     * @param slope Receives the rate of change in units per ms
+     */
+    void sample(size_t lane, float now, float &value, float &slope) const
+    {
+        float raw = (now - this->start_time[lane]) * this->inv_duration[lane];
+        if (raw >= 1.0f)
+        {
+            value = this->end[lane];
+            slope = 0.0f;
+            return;
+        }
+
+        float prog = std::max(raw, 0.0f);
+        float rest = 1.0f - prog;
+        float range = this->end[lane] - this->start[lane];
+        float k = this->velocity[lane];
+
+        value = this->start[lane] + prog * range + k * prog * rest * rest;
+        slope = (range + k * rest * (1.0f - 3.0f * prog)) * this->inv_duration[lane];
+    }
+
+public:
+    /**
+     * @brief Animates a property towards a target, retargeting its lane if it is already animating
+     *
+     * @param property Property to animate
+     * @param from Start value, ignored when the property is mid-animation
+     * @param target End value
+     * @param duration Duration in ms
+     * @param now Start time in microseconds
+     */
+    void animate_to(ObservableProperty<float> *property, float from, float target, int64_t duration, int64_t now)
+    {
+        if (this->properties.empty())
+        {
+            this->epoch = now;
+        }
+
+        float relative = (float)((double)(now - this->epoch) * 0.001);
+        float inv = 1.0f / (float)std::max<int64_t>(duration, 1);
+
+        auto found = this->lanes.find(property);
+        if (found == this->lanes.end())
+        {
+            this->lanes.emplace(property, (uint32_t)this->properties.size());
+            this->start.push_back(from);
+            this->end.push_back(target);
+            this->velocity.push_back(0.0f);
+            this->start_time.push_back(relative);
+            this->inv_duration.push_back(inv);
+            this->properties.push_back(property);
+            return;
+        }
+
+        size_t lane = found->second;
+        float value;
+        float slope;
+        this->sample(lane, relative, value, slope);
+
+        // Pick the blend coefficient so the new segment starts with the old slope
+        this->start[lane] = value;
+        this->end[lane] = target;
+        this->velocity[lane] = slope * (float)std::max<int64_t>(duration, 1) - (target - value);
+        this->start_time[lane] = relative;
+        this->inv_duration[lane] = inv;
+    }
+
+    /**
+     * @brief Starts a lane that continues motion handed over from another animation
+     *
+     * The blend coefficient is chosen so the lane starts at from with the
+     * given slope, as for a retarget, then eases into a linear approach.
+     *
+     * @param property Property to animate, must not already have a lane
+     * @param from Current value
+     * @param slope Current rate of change in units per ms
+     * @param target End value
+     * @param duration Duration in ms
+     * @param now Start time in microseconds
+     */
+    void animate_from(ObservableProperty<float> *property, float from, float slope, float target, int64_t duration,
+                      int64_t now)
+    {
+        this->animate_to(property, from, target, duration, now);
+
+        size_t lane = this->lanes.find(property)->second;
+        this->velocity[lane] = slope * (float)std::max<int64_t>(duration, 1) - (target - from);
+    }
+
+    /**
+     * @return true The property has a lane
+     */
+    bool contains(const ObservableProperty<float> *property) const
+    {
+        return this->lanes.count(property) != 0;
+    }
+
+    /**
+     * @brief Removes a property's lane, leaving the property at its last written value
+     *
+     * @param property Property to stop animating
+     * @return true The property had a lane
+     */
+    bool cancel(const ObservableProperty<float> *property)
+    {
+        auto found = this->lanes.find(property);
+        if (found == this->lanes.end())
+        {
+            return false;
+        }
+        this->remove(found->second);
+        return true;
+    }
+
+    /**
+     * @brief Removes a property's lane, reporting where it was so another animation can take over
+     *
+     * @param property Property to release
+     * @param now Time in microseconds to sample the lane at
+     * @param value Receives the lane's current value
+     * @param slope Receives its rate of change in units per ms
+     * @return true The property had a lane
+     */
+    bool take(const ObservableProperty<float> *property, int64_t now, float &value, float &slope)
+    {
+        auto found = this->lanes.find(property);
+        if (found == this->lanes.end())
+        {
+            return false;
+        }
+
+        size_t lane = found->second;
+        this->sample(lane, (float)((double)(now - this->epoch) * 0.001), value, slope);
+        this->remove(lane);
+        return true;
+    }
+
+    /**
+     * @brief Adds a prepped animation, retargeting the property's lane if it has one
+     *
+     * @param animation Animation whose start time has already been set by prep()
+     */
+    void add(const Animation<float> &animation)
+    {
+        this->animate_to(animation.property, animation.start, animation.end, animation.duration,
+                         animation.get_start_time());
+    }
+
+    /**
+     * @brief Appends the state of every lane
+     *
+     * @param now Time in microseconds the elapsed times are measured against
+     * @param out Receives one entry per lane
+     */
+    void export_lanes(int64_t now, std::vector<FloatLaneState> &out) const
+    {
+        float relative = (float)((double)(now - this->epoch) * 0.001);
+        for (size_t lane = 0; lane < this->properties.size(); lane++)
+        {
+            out.push_back(FloatLaneState{this->properties[lane], this->start[lane], this->end[lane],
+                                         this->velocity[lane], relative - this->start_time[lane],
+                                         this->inv_duration[lane]});
+        }
+    }
+
+    /**
+     * @brief Recreates a lane exported by export_lanes, replacing the property's current lane
+     *
+     * @param state Exported lane
+     * @param now Time in microseconds the lane's elapsed time is relative to
+     */
+    void import_lane(const FloatLaneState &state, int64_t now)
+    {
+        if (this->properties.empty())
+        {
+            this->epoch = now;
+        }
+
+        float started = (float)((double)(now - this->epoch) * 0.001) - state.elapsed;
+        size_t lane;
+        auto found = this->lanes.find(state.property);
+        if (found == this->lanes.end())
+        {
+            lane = this->properties.size();
+            this->lanes.emplace(state.property, (uint32_t)lane);
+            this->start.push_back(0.0f);
+            this->end.push_back(0.0f);
+            this->velocity.push_back(0.0f);
+            this->start_time.push_back(0.0f);
+            this->inv_duration.push_back(0.0f);
+            this->properties.push_back(state.property);
+        }
+        else
+        {
+            lane = found->second;
+        }
+
+        this->start[lane] = state.start;
+        this->end[lane] = state.end;
+        this->velocity[lane] = state.velocity;
+        this->start_time[lane] = started;
+        this->inv_duration[lane] = state.inv_duration;
+    }
+
+    void tick(int64_t now) override
+    {
+        size_t count = this->properties.size();
+        this->completed = 0;
+        if (count == 0)
+        {
+            return;
+        }
+
+        this->values.resize(count);
+        this->done.resize((count + 7) / 8);
+        if (now - this->epoch > REBASE_MS * 1000)
+        {
+            this->rebase(now);
+        }
+        this->frame_now = (float)((double)(now - this->epoch) * 0.001);
+
+        // Evaluate, in parallel for large stores, into the scratch buffers only
+        size_t chunks = (count + CHUNK_LANES - 1) / CHUNK_LANES;
+        if (this->workers && chunks > 1)
+        {
+            this->workers->run(chunks, &FloatAnimationStore::evaluate_chunk, this);
+        }
+        else
+        {
+            this->evaluate(0, count);
+        }
+
+        // Commit on the calling thread so View state is never written concurrently.
+        // Dependents publish once the lanes are retired, so their observers
+        // can start or cancel animations without moving lanes under this loop
+        PropertyBatch::begin_write();
+        for (size_t i = 0; i < count; i++)
+        {
+            this->properties[i]->store(this->values[i]);
+        }
+
+        // Retire from the back so swapped-in lanes have already been visited.
+        // Blocks with no completed lane are skipped with a single byte test.
+        for (size_t block = this->done.size(); block-- > 0;)
+        {
+            uint8_t mask = this->done[block];
+            while (mask)
+            {
+                // Highest set bit first, keeping the walk backwards
+                unsigned bit = 7;
+                while (!(mask & (1u << bit)))
+                {
+                    bit--;
+                }
+                mask &= (uint8_t)~(1u << bit);
+
+                this->remove(block * 8 + bit);
+                this->completed++;
+            }
+        }
+        PropertyBatch::end_write();
+    }
+
+    size_t size() const override
+    {
+        return this->properties.size();
+    }
+
+    void set_workers(AnimationWorkerPool *pool) override
+    {
+        this->workers = pool;
+    }
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "scheduler.h"
+
+/**
+ * @brief Runs scheduler frames on a fixed refresh grid, or from an external vsync
+ *
+ * Frame n is due at origin + n / refresh_hz, computed from the frame index so
+ * there is no drift, and waited for with AnimationCore::wait_until. A frame
+ * that overruns the next deadline skips the deadlines it missed rather than
+ * bursting to catch up, and counts them in missed_frames().
+ *
+ * With no active animations, or only paused groups, run() parks on a
+ * condition variable, with no timer or wakeups, until request_frame() or
+ * stop(). A platform with a vsync source calls on_vsync() instead of run().
+ */
+class FrameDriver
+{
+private:
+    AnimationScheduler &scheduler;
+    int64_t refresh_hz;
+    int64_t spin_us;
+
+    InlineFunction<void(int64_t)> frame_callback;
+
+    int64_t origin_us = 0;
+    int64_t index = 0;
+    int64_t last_vsync_us = 0;
+    uint64_t frame_count = 0;
+    uint64_t missed = 0;
+
+    std::mutex wake_lock;
+    std::condition_variable wake;
+    bool wake_requested = false;
+    std::atomic<bool> stopping{false};
+
+    int64_t deadline(int64_t frame) const
+    {
+        return this->origin_us + frame * 1000000 / this->refresh_hz;
+    }
+
+    void run_frame(int64_t timestamp_us)
+    {
+        this->scheduler.tick(AnimationCore::begin_frame(timestamp_us));
+        if (this->frame_callback)
+        {
+            this->frame_callback(timestamp_us);
+        }
+        AnimationCore::end_frame();
+        this->frame_count++;
+    }
+
+    // Runs paced frames until no animations need them or stop() is called. The first
+    // frame always runs while any are active, and picks up groups resumed since the last tick
+    void run_active()
+    {
+        this->origin_us = AnimationCore::now_us();
+        this->index = 0;
+
+        while (this->scheduler.active() > 0 && !this->stopping.load(std::memory_order_relaxed))
+        {
+            int64_t due = this->deadline(this->index);
+            AnimationCore::wait_until(due, this->spin_us);
+            this->run_frame(due);
+            if (this->scheduler.running() == 0)
+            {
+                break;
+            }
+
+            // Skip every deadline that already passed while the frame ran
+            int64_t now = AnimationCore::now_us();
+            int64_t next = this->index + 1;
+            if (now > this->deadline(next))
+            {
+                int64_t late = (now - this->origin_us) * this->refresh_hz / 1000000 + 1;
+                this->missed += late - next;
+                next = late;
+            }
+            this->index = next;
+        }
+    }
+
+public:
+    /**
+     * @param scheduler Scheduler to tick, must outlive the driver
+     * @param refresh_hz Frames per second
+     * @param spin_us Spin this long before each deadline instead of sleeping
+     */
+    explicit FrameDriver(AnimationScheduler &scheduler, int64_t refresh_hz = 120, int64_t spin_us = 500)
+        : scheduler(scheduler), refresh_hz(refresh_hz), spin_us(spin_us)
+    {
+    }
+
+    FrameDriver(const FrameDriver &) = delete;
+    FrameDriver &operator=(const FrameDriver &) = delete;
+
+    /**
+     * @brief Called after every frame's tick with the frame timestamp, e.g. to render
+     *
+     * @param callback Callable taking the frame timestamp in microseconds
+     */
+    template <typename F>
+    void set_frame_callback(F callback)
+    {
+        this->frame_callback = InlineFunction<void(int64_t)>(std::move(callback));
+    }
+
+    /**
+     * @brief Paces frames until every animation has retired or only paused groups remain, then returns
+     */
+    void run_until_idle()
+    {
+        this->run_active();
+    }
+
+    /**
+     * @brief Paces frames while animations are active and parks while they are not, until stop()
+     *
+     * Animations added from other code on this thread, such as frame callbacks,
+     * are picked up directly. Work arriving from elsewhere, including resuming
+     * a paused group, must be followed by request_frame() to wake a parked driver.
+     *
+     * AnimationScheduler is not synchronised. While run() is running only this
+     * thread, frame callbacks included, may call the scheduler: another thread
+     * cannot tell whether the driver is parked, and a frame may start at any
+     * moment after request_frame(). Other threads may call animate_to, cancel
+     * and the like only while no run() or on_vsync() is in progress, or must
+     * hand the request to this thread.
+     */
+    void run()
+    {
+        while (!this->stopping.load(std::memory_order_relaxed))
+        {
+            this->run_active();
+
+            std::unique_lock<std::mutex> lock(this->wake_lock);
+            this->wake.wait(lock, [this]
+                            { return this->wake_requested || this->stopping.load(std::memory_order_relaxed); });
+            this->wake_requested = false;
+        }
+    }
+
+    /**
+     * @brief Wakes a parked run() to check for animations, callable from any thread
+     */
+    void request_frame()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->wake_lock);
+            this->wake_requested = true;
+        }
+        this->wake.notify_one();
+    }
+
+    /**
+     * @brief Makes run() return after the current frame, callable from any thread
+     */
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->wake_lock);
+            this->stopping.store(true, std::memory_order_relaxed);
+        }
+        this->wake.notify_one();
+    }
+
+    /**
+     * @brief Runs one frame for an external vsync signal
+     *
+     * A gap of more than one and a half refresh periods since the previous
+     * vsync counts the skipped periods as missed frames. Once a vsync leaves
+     * no animations needing frames the next one starts a fresh run, so idle
+     * time is never counted. As with run(), the scheduler must not be called
+     * from another thread while this runs.
+     *
+     * @param timestamp_us Vsync time in microseconds on the steady_clock timeline
+     * @return true Animations other than paused groups remain active
+     */
+    bool on_vsync(int64_t timestamp_us)
+    {
+        if (this->last_vsync_us != 0)
+        {
+            int64_t periods = ((timestamp_us - this->last_vsync_us) * this->refresh_hz * 2 + 1000000) / 2000000;
+            if (periods > 1)
+            {
+                this->missed += periods - 1;
+            }
+        }
+        this->last_vsync_us = timestamp_us;
+
+        this->run_frame(timestamp_us);
+        if (this->scheduler.running() == 0)
+        {
+            this->last_vsync_us = 0;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @return uint64_t Frames run so far
+     */
+    uint64_t frames() const
+    {
+        return this->frame_count;
+    }
+
+    /**
+     * @return uint64_t Deadlines or vsync periods that passed without a frame
+     */
+    uint64_t missed_frames() const
+    {
+        return this->missed;
+    }
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "property.h"
+
+struct Point
+{
+    UIFloat x;
+    UIFloat y;
+};
+
+struct Size
+{
+    UIFloat width;
+    UIFloat height;
+};
+
+struct Rect
+{
+    Point position;
+    Size size;
+};
+
+struct Color
+{
+    UIInt r;
+    UIInt g;
+    UIInt b;
+};
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "animation.h"
+
+/**
+ * @brief Targets, start values and end values of one value type inside an AnimationGroup
+ */
+template <typename T>
+struct GroupLanes
+{
+    std::vector<ObservableProperty<T> *> targets;
+    std::vector<T> start;
+    std::vector<T> end;
+
+    void add(const Animation<T> &animation)
+    {
+        this->targets.push_back(animation.property);
+        this->start.push_back(animation.start);
+        this->end.push_back(animation.end);
+    }
+
+    void write(float prog)
+    {
+        for (size_t i = 0; i < this->targets.size(); i++)
+        {
+            this->targets[i]->store(lerp(this->start[i], this->end[i], prog));
+        }
+    }
+
+    void write_end()
+    {
+        for (size_t i = 0; i < this->targets.size(); i++)
+        {
+            this->targets[i]->store(this->end[i]);
+        }
+    }
+};
+
+/**
+ * @brief Timeline that runs many animations with one start time and duration
+ *
+ * Built from ordinary Animation<T> descriptions, of which only the property,
+ * start and end are used. The group evaluates and eases its progress once
+ * per frame and then only lerps each member, and it is paused, resumed, seeked
+ * or cancelled as one unit, which suits a screen transition across hundreds
+ * of views.
+ *
+ * @tparam Easing Curve type with a static apply(t), shared by every member
+ */
+template <typename Easing = Linear>
+class AnimationGroup
+{
+private:
+    int64_t start_time = 0;
+    double inv_duration = 0.0;
+
+    // Set while paused, the track time the group is frozen at, in microseconds
+    int64_t paused_at = -1;
+    // The members have been written at the paused position
+    bool frozen = false;
+    bool cancelled = false;
+
+    GroupLanes<float> floats;
+    GroupLanes<int> ints;
+
+public:
+    // In milliseconds, shared by every member
+    int64_t duration;
+
+    /**
+     * @brief Adds a member, its duration is ignored in favour of the group's
+     *
+     * @param animation Animation whose property, start and end are used
+     */
+    void add(const Animation<float> &animation)
+    {
+        this->floats.add(animation);
+    }
+
+    void add(const Animation<int> &animation)
+    {
+        this->ints.add(animation);
+    }
+
+    /**
+     * @return size_t Number of member animations
+     */
+    size_t size() const
+    {
+        return this->floats.targets.size() + this->ints.targets.size();
+    }
+
+    /**
+     * @brief Starts the group at AnimationCore::start_time()
+     */
+    void prep()
+    {
+        this->prep(AnimationCore::start_time());
+    }
+
+    /**
+     * @param now Start time in microseconds since the steady_clock epoch
+     */
+    void prep(int64_t now)
+    {
+        this->start_time = now;
+        this->inv_duration = 1.0 / ((double)std::max<int64_t>(this->duration, 1) * 1000.0);
+    }
+
+    /**
+     * @brief Freezes every member where it is
+     *
+     * @param now Current time in microseconds
+     */
+    void pause(int64_t now)
+    {
+        if (this->paused_at < 0)
+        {
+            this->paused_at = now - this->start_time;
+            this->frozen = false;
+        }
+    }
+
+    /**
+     * @brief Continues from where pause left off
+     *
+     * @param now Current time in microseconds
+     */
+    void resume(int64_t now)
+    {
+        if (this->paused_at >= 0)
+        {
+            this->start_time = now - this->paused_at;
+            this->paused_at = -1;
+        }
+    }
+
+    bool paused() const
+    {
+        return this->paused_at >= 0;
+    }
+
+    /**
+     * @brief Jumps the whole group to a point on its timeline, keeping the paused state
+     *
+     * @param now Current time in microseconds
+     * @param time Timeline position in ms
+     */
+    void seek(int64_t now, float time)
+    {
+        int64_t offset = (int64_t)((double)time * 1000.0);
+        if (this->paused_at >= 0)
+        {
+            this->paused_at = offset;
+            this->frozen = false;
+        }
+        else
+        {
+            this->start_time = now - offset;
+        }
+    }
+
+    /**
+     * @brief Stops every member where it is; the group retires on its next frame
+     */
+    void cancel()
+    {
+        this->cancelled = true;
+    }
+
+    /**
+     * @brief Evaluates the group's progress once and writes every member
+     *
+     * A paused group is written once at its frozen position, then reports
+     * itself idle without writing until it is resumed or seeked.
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     * @return AnimationStep<float> Linear group progress and completion status
+     */
+    AnimationStep<float> advance(int64_t now)
+    {
+        AnimationStep<float> step;
+        if (this->cancelled)
+        {
+            step.value = 0.0f;
+            step.completed = true;
+            return step;
+        }
+
+        int64_t elapsed = this->paused_at >= 0 ? this->paused_at : now - this->start_time;
+        step.value = std::max((float)((double)elapsed * this->inv_duration), 0.0f);
+        step.completed = step.value >= 1.0f && this->paused_at < 0;
+
+        if (this->paused_at >= 0)
+        {
+            if (this->frozen)
+            {
+                step.idle = true;
+                return step;
+            }
+            this->frozen = true;
+        }
+
+        if (step.value >= 1.0f)
+        {
+            this->floats.write_end();
+            this->ints.write_end();
+        }
+        else
+        {
+            float eased = Easing::apply(step.value);
+            this->floats.write(eased);
+            this->ints.write(eased);
+        }
+        return step;
+    }
+};
+
+#if OBSERVER_EXTERN_TEMPLATES
+extern template class AnimationGroup<Linear>;
+#endif
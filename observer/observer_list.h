@@ -0,0 +1,460 @@
+#pragma once
+
+#include "containers.h"
+#include "stats.h"
+
+/**
+ * @brief Identifies one registered observer, returned by ObservableProperty::add_observer
+ *
+ * Handles are generation checked, so removing through a stale handle is a
+ * harmless no-op rather than removing whichever observer reused the slot.
+ */
+struct ObserverHandle
+{
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool valid() const
+    {
+        return this->generation != 0;
+    }
+};
+
+/**
+ * @brief Observer storage for ObservableProperty
+ *
+ * The first observer is stored inline, so a property with at most one
+ * observer, such as every property of a View with its default observers,
+ * never allocates. Further observers live in a spill block allocated on the
+ * second one, where they are kept dense so notification is a contiguous walk
+ * and a slot map translates handles to dense positions so removal is O(1)
+ * swap-and-pop.
+ *
+ * Notification calls observers in place, by reference. Observers added while a
+ * notification is running are parked and appended once the outermost
+ * notification returns, so they are first called on the next write and the
+ * storage never relocates under a running observer. Observers removed while a
+ * notification is running are not called again, including later in the same
+ * pass, and are compacted away once it returns. A write made from inside an
+ * observer notifies the current list again, recursively. Notification order
+ * is unspecified once observers have been removed.
+ */
+template <typename T>
+class ObserverList
+{
+public:
+    typedef InlineFunction<void(T, T)> Observer;
+
+private:
+    // Entry::slot of a removed entry, and the end of the free slot list
+    static constexpr uint32_t DEAD = UINT32_MAX;
+    // ObserverHandle::slot of the inline observer
+    static constexpr uint32_t HEAD = UINT32_MAX - 1;
+    // Set in Slot::index while the entry is parked in pending
+    static constexpr uint32_t PENDING = 1u << 31;
+
+    struct Entry
+    {
+        Observer observer;
+        uint32_t slot;
+    };
+
+    struct Slot
+    {
+        // Dense position, pending position | PENDING, or next free slot
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    // Every observer but the inline one
+    struct Spill
+    {
+        std::vector<Entry> items;
+        std::vector<Slot> slots;
+        std::vector<Entry> pending;
+        uint32_t free_slots = DEAD;
+        uint32_t live = 0;
+        bool has_dead = false;
+    };
+
+    enum class HeadState : uint8_t
+    {
+        Empty,
+        Live,
+        // Removed during a notification, destroyed once it returns
+        Dead
+    };
+
+    Observer head;
+    std::unique_ptr<Spill> spill;
+    uint32_t head_generation = 0;
+    uint16_t dispatch_depth = 0;
+    HeadState head_state = HeadState::Empty;
+
+    uint32_t allocate_slot()
+    {
+        Spill &spill = *this->spill;
+        if (spill.free_slots != DEAD)
+        {
+            uint32_t slot = spill.free_slots;
+            spill.free_slots = spill.slots[slot].index;
+            return slot;
+        }
+        spill.slots.push_back(Slot{0, 1});
+        return (uint32_t)spill.slots.size() - 1;
+    }
+
+    void free_slot(uint32_t slot)
+    {
+        Spill &spill = *this->spill;
+        Slot &entry = spill.slots[slot];
+        if (++entry.generation == 0)
+        {
+            entry.generation = 1;
+        }
+        entry.index = spill.free_slots;
+        spill.free_slots = slot;
+    }
+
+    void erase(size_t index)
+    {
+        Spill &spill = *this->spill;
+        size_t last = spill.items.size() - 1;
+        if (index != last)
+        {
+            spill.items[index] = std::move(spill.items[last]);
+            if (spill.items[index].slot != DEAD)
+            {
+                spill.slots[spill.items[index].slot].index = (uint32_t)index;
+            }
+        }
+        spill.items.pop_back();
+    }
+
+    void compact()
+    {
+        // Backwards, so every entry swapped in has already been checked
+        for (size_t i = this->spill->items.size(); i-- > 0;)
+        {
+            if (this->spill->items[i].slot == DEAD)
+            {
+                this->erase(i);
+            }
+        }
+        this->spill->has_dead = false;
+    }
+
+    void flush_pending()
+    {
+        Spill &spill = *this->spill;
+        for (auto &entry : spill.pending)
+        {
+            if (entry.slot != DEAD)
+            {
+                spill.slots[entry.slot].index = (uint32_t)spill.items.size();
+                spill.items.push_back(std::move(entry));
+            }
+        }
+        spill.pending.clear();
+    }
+
+    void copy_from(const ObserverList &other)
+    {
+        bool head_live = other.head_state == HeadState::Live;
+        this->head = head_live ? other.head : Observer();
+        this->head_state = head_live ? HeadState::Live : HeadState::Empty;
+        this->head_generation = other.head_generation;
+
+        this->spill.reset(other.spill ? new Spill(*other.spill) : nullptr);
+        if (this->spill)
+        {
+            // Settle whatever the source had parked mid-notification
+            this->compact();
+            this->flush_pending();
+        }
+    }
+
+public:
+    ObserverList() = default;
+
+    ObserverList(const ObserverList &other)
+    {
+        this->copy_from(other);
+    }
+
+    ObserverList &operator=(const ObserverList &other)
+    {
+        if (this != &other)
+        {
+            this->copy_from(other);
+        }
+        return *this;
+    }
+
+    template <typename F>
+    ObserverHandle add(F &&observer)
+    {
+        if (this->head_state == HeadState::Empty && this->dispatch_depth == 0)
+        {
+            this->head = Observer(std::forward<F>(observer));
+            this->head_state = HeadState::Live;
+            if (++this->head_generation == 0)
+            {
+                this->head_generation = 1;
+            }
+            return ObserverHandle{HEAD, this->head_generation};
+        }
+
+        if (!this->spill)
+        {
+            this->spill.reset(new Spill());
+        }
+        Spill &spill = *this->spill;
+        uint32_t slot = this->allocate_slot();
+        spill.live++;
+
+        if (this->dispatch_depth == 0)
+        {
+            spill.slots[slot].index = (uint32_t)spill.items.size();
+            spill.items.push_back(Entry{Observer(std::forward<F>(observer)), slot});
+        }
+        else
+        {
+            spill.slots[slot].index = PENDING | (uint32_t)spill.pending.size();
+            spill.pending.push_back(Entry{Observer(std::forward<F>(observer)), slot});
+        }
+
+        return ObserverHandle{slot, spill.slots[slot].generation};
+    }
+
+    /**
+     * @brief Removes an observer in O(1)
+     *
+     * @param handle Handle returned when the observer was added
+     * @return true The observer was registered and has been removed
+     * @return false The handle was stale or never valid
+     */
+    bool remove(ObserverHandle handle)
+    {
+        if (handle.slot == HEAD)
+        {
+            if (this->head_state != HeadState::Live || this->head_generation != handle.generation)
+            {
+                return false;
+            }
+            if (this->dispatch_depth > 0)
+            {
+                // The observer may be the one running, destroy it after the pass
+                this->head_state = HeadState::Dead;
+            }
+            else
+            {
+                this->head = Observer();
+                this->head_state = HeadState::Empty;
+            }
+            return true;
+        }
+
+        if (!this->spill || handle.slot >= this->spill->slots.size() ||
+            this->spill->slots[handle.slot].generation != handle.generation)
+        {
+            return false;
+        }
+
+        Spill &spill = *this->spill;
+        uint32_t index = spill.slots[handle.slot].index;
+        this->free_slot(handle.slot);
+        spill.live--;
+
+        if (index & PENDING)
+        {
+            spill.pending[index & ~PENDING].slot = DEAD;
+        }
+        else if (this->dispatch_depth > 0)
+        {
+            // The observer may be the one running, destroy it after the pass
+            spill.items[index].slot = DEAD;
+            spill.has_dead = true;
+        }
+        else
+        {
+            this->erase(index);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Removes every observer
+     *
+     * During a notification none of them is called again and they are
+     * destroyed once it returns, as with remove.
+     */
+    void clear()
+    {
+        if (this->dispatch_depth == 0)
+        {
+            this->head = Observer();
+            this->head_state = HeadState::Empty;
+            this->spill.reset();
+            return;
+        }
+
+        if (this->head_state == HeadState::Live)
+        {
+            this->head_state = HeadState::Dead;
+        }
+        if (this->spill)
+        {
+            Spill &spill = *this->spill;
+            for (Entry &entry : spill.items)
+            {
+                if (entry.slot != DEAD)
+                {
+                    this->free_slot(entry.slot);
+                    entry.slot = DEAD;
+                    spill.has_dead = true;
+                }
+            }
+            for (Entry &entry : spill.pending)
+            {
+                if (entry.slot != DEAD)
+                {
+                    this->free_slot(entry.slot);
+                    entry.slot = DEAD;
+                }
+            }
+            spill.live = 0;
+        }
+    }
+
+    static bool remove_thunk(void *list, ObserverHandle handle)
+    {
+        return static_cast<ObserverList *>(list)->remove(handle);
+    }
+
+    /**
+     * @brief Calls every registered observer with the old and new value
+     *
+     * @param old Value before the write
+     * @param current Value being written
+     */
+    void notify(T old, T current)
+    {
+        // Only the observers present when the notification started are called
+        size_t count = this->spill ? this->spill->items.size() : 0;
+
+        this->dispatch_depth++;
+        if (this->head_state == HeadState::Live)
+        {
+            this->head(old, current);
+            ANIMATION_STAT(observer_callbacks, 1);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            Entry &entry = this->spill->items[i];
+            if (entry.slot != DEAD)
+            {
+                entry.observer(old, current);
+                ANIMATION_STAT(observer_callbacks, 1);
+            }
+        }
+        this->dispatch_depth--;
+
+        if (this->dispatch_depth == 0)
+        {
+            if (this->head_state == HeadState::Dead)
+            {
+                this->head = Observer();
+                this->head_state = HeadState::Empty;
+            }
+            if (this->spill)
+            {
+                if (this->spill->has_dead)
+                {
+                    this->compact();
+                }
+                this->flush_pending();
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return (this->head_state == HeadState::Live ? 1 : 0) + (this->spill ? this->spill->live : 0);
+    }
+
+    bool empty() const
+    {
+        return this->head_state != HeadState::Live && (!this->spill || this->spill->live == 0);
+    }
+};
+
+/**
+ * @brief Removes its observer when destroyed
+ *
+ * Returned by ObservableProperty::subscribe. Must not outlive the property it
+ * was obtained from.
+ */
+class Subscription
+{
+private:
+    void *list = nullptr;
+    bool (*remove)(void *, ObserverHandle) = nullptr;
+    ObserverHandle handle;
+
+public:
+    Subscription() = default;
+
+    Subscription(void *list, bool (*remove)(void *, ObserverHandle), ObserverHandle handle)
+        : list(list), remove(remove), handle(handle)
+    {
+    }
+
+    Subscription(const Subscription &) = delete;
+    Subscription &operator=(const Subscription &) = delete;
+
+    Subscription(Subscription &&other) noexcept : list(other.list), remove(other.remove), handle(other.handle)
+    {
+        other.list = nullptr;
+    }
+
+    Subscription &operator=(Subscription &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->disconnect();
+            this->list = other.list;
+            this->remove = other.remove;
+            this->handle = other.handle;
+            other.list = nullptr;
+        }
+        return *this;
+    }
+
+    ~Subscription()
+    {
+        this->disconnect();
+    }
+
+    /**
+     * @brief Removes the observer now, safe to call more than once
+     */
+    void disconnect()
+    {
+        if (this->list)
+        {
+            this->remove(this->list, this->handle);
+            this->list = nullptr;
+        }
+    }
+
+    bool connected() const
+    {
+        return this->list != nullptr;
+    }
+};
+
+#if OBSERVER_EXTERN_TEMPLATES
+extern template class ObserverList<float>;
+extern template class ObserverList<int>;
+#endif
@@ -0,0 +1,574 @@
+#pragma once
+
+#include "view.h"
+
+/**
+ * @brief Observers of packed properties, kept out of line and only for properties that have any
+ *
+ * Entries are keyed by the owning object and a property index within it and
+ * are heap allocated. An entry erased while its observers are being notified,
+ * because an observer destroyed the owner, stops notifying and is freed once
+ * the notification returns. Like ObservableProperty, not thread-safe.
+ *
+ * @tparam T Value type
+ */
+template <typename T>
+class ObserverSideTable
+{
+public:
+    struct Key
+    {
+        const void *owner;
+        uint32_t index;
+
+        bool operator==(const Key &other) const
+        {
+            return this->owner == other.owner && this->index == other.index;
+        }
+    };
+
+    struct Entry
+    {
+        ObserverList<T> observers;
+        // Values around the open batch, valid while batched is set
+        T batch_old;
+        T batch_new;
+        bool batched = false;
+        // Notifications of this entry in progress, see erase
+        uint32_t notifying = 0;
+        // Erased while notifying, freed by whoever finishes the last notification
+        bool erased = false;
+    };
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            return std::hash<const void *>()(key.owner) ^ ((size_t)key.index * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    std::unordered_map<Key, std::unique_ptr<Entry>, KeyHash> entries;
+
+public:
+    static ObserverSideTable &global()
+    {
+        static ObserverSideTable table;
+        return table;
+    }
+
+    Entry *find(Key key)
+    {
+        auto it = this->entries.find(key);
+        return it == this->entries.end() ? nullptr : it->second.get();
+    }
+
+    Entry &get(Key key)
+    {
+        std::unique_ptr<Entry> &entry = this->entries[key];
+        if (!entry)
+        {
+            entry.reset(new Entry());
+        }
+        return *entry;
+    }
+
+    void erase(Key key)
+    {
+        auto it = this->entries.find(key);
+        if (it == this->entries.end())
+        {
+            return;
+        }
+        if (it->second->notifying > 0)
+        {
+            it->second->erased = true;
+            it->second->observers.clear();
+            it->second.release();
+        }
+        this->entries.erase(it);
+    }
+
+    /**
+     * @brief Notifies an entry's observers, tolerating the entry being erased by one of them
+     *
+     * @return true The entry is still in the table
+     */
+    static bool notify(Entry *entry, T old, T current)
+    {
+        entry->notifying++;
+        entry->observers.notify(old, current);
+        if (--entry->notifying == 0 && entry->erased)
+        {
+            delete entry;
+            return false;
+        }
+        return !entry->erased;
+    }
+
+    size_t size() const
+    {
+        return this->entries.size();
+    }
+};
+
+/**
+ * @brief Reference to one value in a packed property block
+ *
+ * Behaves like an ObservableProperty with AlwaysNotify: assignment stores the
+ * value, sets the owner's dirty bit and, only if the property has ever had an
+ * observer, looks up its ObserverSideTable entry and notifies, coalescing
+ * inside a PropertyBatch. Unobserved writes never touch the side table.
+ *
+ * A proxy points into its owner's storage; do not keep one across calls that
+ * may reallocate it, such as ViewTable::create.
+ *
+ * @tparam T Value type
+ */
+template <typename T>
+class PackedProperty
+{
+public:
+    typedef typename ObserverSideTable<T>::Key Key;
+    typedef typename ObserverSideTable<T>::Entry Entry;
+
+private:
+    T *slot;
+    uint32_t *dirty;
+    uint32_t *observed;
+    uint32_t bit;
+    Key key;
+
+    // Looks the entry up again, the owner may have been destroyed since the write
+    static void flush_batch(Key key)
+    {
+        Entry *entry = ObserverSideTable<T>::global().find(key);
+        if (!entry || !entry->batched)
+        {
+            return;
+        }
+        entry->batched = false;
+        ObserverSideTable<T>::notify(entry, entry->batch_old, entry->batch_new);
+    }
+
+public:
+    PackedProperty(T *slot, uint32_t *dirty, uint32_t *observed, uint32_t bit, Key key)
+        : slot(slot), dirty(dirty), observed(observed), bit(bit), key(key)
+    {
+    }
+
+    T get() const
+    {
+        return *this->slot;
+    }
+
+    operator T() const
+    {
+        return *this->slot;
+    }
+
+    /**
+     * @brief Writes the value and marks it dirty without calling observers
+     *
+     * @param new_value Value to store
+     */
+    void store(const T new_value)
+    {
+        *this->slot = new_value;
+        *this->dirty |= this->bit;
+    }
+
+    PackedProperty &operator=(const T new_value)
+    {
+        if (!(*this->observed & this->bit))
+        {
+            this->store(new_value);
+            return *this;
+        }
+
+        Entry *entry = ObserverSideTable<T>::global().find(this->key);
+        if (PropertyBatch::active())
+        {
+            if (!entry->batched)
+            {
+                entry->batched = true;
+                entry->batch_old = *this->slot;
+                PropertyBatch::enqueue([key = this->key] { flush_batch(key); });
+            }
+            else
+            {
+                ANIMATION_STAT(notifications_coalesced, 1);
+            }
+            entry->batch_new = new_value;
+            this->store(new_value);
+            return *this;
+        }
+
+        // An observer that destroys the owner leaves nothing to store into
+        PropertyBatch::begin_write();
+        if (ObserverSideTable<T>::notify(entry, *this->slot, new_value))
+        {
+            this->store(new_value);
+        }
+        PropertyBatch::end_write();
+        return *this;
+    }
+
+    PackedProperty &operator=(const PackedProperty &other)
+    {
+        return *this = other.get();
+    }
+
+    /**
+     * @brief Observer will be called in the event that the value is assigned
+     *
+     * @param observer Lambda to be called
+     * @return ObserverHandle Handle for remove_observer
+     */
+    template <typename F>
+    ObserverHandle add_observer(F observer)
+    {
+        Entry &entry = ObserverSideTable<T>::global().get(this->key);
+        *this->observed |= this->bit;
+        return entry.observers.add(std::move(observer));
+    }
+
+    /**
+     * @brief Stops an observer from being called
+     *
+     * The side table entry is kept until the owner is destroyed, so removing
+     * observers from inside a notification is safe.
+     *
+     * @param handle Handle returned by add_observer
+     * @return true The observer was removed
+     */
+    bool remove_observer(ObserverHandle handle)
+    {
+        Entry *entry = ObserverSideTable<T>::global().find(this->key);
+        return entry && entry->observers.remove(handle);
+    }
+};
+
+/**
+ * @brief View with its values packed together and its observers out of line
+ *
+ * The seven values take 28 contiguous bytes instead of seven ObservableProperty
+ * instances, each carrying its own observer storage; observers live in
+ * ObserverSideTable and cost nothing for properties that have none. Properties
+ * are reached through PackedProperty proxies, e.g. view.width() = 500.0f.
+ * Dirty bits match View::DirtyBits.
+ *
+ * Observers are keyed by the view's address, so it is neither copyable nor movable.
+ */
+class PackedView
+{
+public:
+    enum Field : uint32_t
+    {
+        X,
+        Y,
+        WIDTH,
+        HEIGHT,
+        R,
+        G,
+        B,
+        FIELD_COUNT
+    };
+
+    struct Values
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float width = 0.0f;
+        float height = 0.0f;
+        int r = 0;
+        int g = 0;
+        int b = 0;
+    };
+
+    // Read directly by renderers, write through the proxies so observers fire
+    Values values;
+
+    // Set by every property write, cleared by the renderer once it has pulled the view
+    uint32_t dirty = 0;
+
+private:
+    // Bit per Field that has ever had an observer
+    uint32_t observed = 0;
+
+    template <typename T>
+    PackedProperty<T> property(T *slot, Field field)
+    {
+        return PackedProperty<T>(slot, &this->dirty, &this->observed, 1u << field,
+                                 typename PackedProperty<T>::Key{this, field});
+    }
+
+public:
+    PackedView() = default;
+    PackedView(const PackedView &) = delete;
+    PackedView &operator=(const PackedView &) = delete;
+
+    ~PackedView()
+    {
+        for (uint32_t field = 0; this->observed != 0 && field < FIELD_COUNT; field++)
+        {
+            if (!(this->observed & (1u << field)))
+            {
+                continue;
+            }
+            if (field < R)
+            {
+                ObserverSideTable<float>::global().erase({this, field});
+            }
+            else
+            {
+                ObserverSideTable<int>::global().erase({this, field});
+            }
+        }
+    }
+
+    PackedProperty<float> x() { return this->property(&this->values.x, X); }
+    PackedProperty<float> y() { return this->property(&this->values.y, Y); }
+    PackedProperty<float> width() { return this->property(&this->values.width, WIDTH); }
+    PackedProperty<float> height() { return this->property(&this->values.height, HEIGHT); }
+    PackedProperty<int> r() { return this->property(&this->values.r, R); }
+    PackedProperty<int> g() { return this->property(&this->values.g, G); }
+    PackedProperty<int> b() { return this->property(&this->values.b, B); }
+
+    /**
+     * @return true Some property has been written since the last take_dirty()
+     */
+    bool is_dirty() const
+    {
+        return this->dirty != 0;
+    }
+
+    /**
+     * @brief Returns and clears the dirty bits, called once per frame by the renderer
+     *
+     * @return uint32_t View::DirtyBits of the properties written since the last call
+     */
+    uint32_t take_dirty()
+    {
+        uint32_t bits = this->dirty;
+        this->dirty = 0;
+        return bits;
+    }
+};
+
+static_assert((1u << PackedView::X) == View::DIRTY_X && (1u << PackedView::B) == View::DIRTY_B,
+              "PackedView fields must line up with View::DirtyBits");
+
+/**
+ * @brief Handle to a view in a ViewTable, stale once the view is destroyed
+ */
+struct ViewId
+{
+    uint32_t index;
+    uint32_t generation;
+};
+
+/**
+ * @brief Every view's values in one structure-of-arrays table
+ *
+ * Each property is a column indexed by ViewId::index, so a layout or render
+ * pass over all widths reads one dense array. Writes and observers go through
+ * the same PackedProperty proxies as PackedView, keyed by the table and index.
+ * Destroyed indices are reused by create(). The property accessors require a
+ * live ViewId and assert on a stale one; take_dirty reports nothing for it.
+ */
+class ViewTable
+{
+private:
+    friend class ViewSnapshot;
+
+    std::vector<float> floats[PackedView::R];
+    std::vector<int> ints[PackedView::FIELD_COUNT - PackedView::R];
+    std::vector<uint32_t> dirty;
+    std::vector<uint32_t> observed;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> free_indices;
+
+    uint32_t key_index(uint32_t index, PackedView::Field field) const
+    {
+        return index * PackedView::FIELD_COUNT + field;
+    }
+
+    PackedProperty<float> float_property(ViewId id, PackedView::Field field)
+    {
+        assert(this->alive(id) && "stale ViewId");
+        return PackedProperty<float>(&this->floats[field][id.index], &this->dirty[id.index],
+                                     &this->observed[id.index], 1u << field,
+                                     PackedProperty<float>::Key{this, this->key_index(id.index, field)});
+    }
+
+    PackedProperty<int> int_property(ViewId id, PackedView::Field field)
+    {
+        assert(this->alive(id) && "stale ViewId");
+        return PackedProperty<int>(&this->ints[field - PackedView::R][id.index], &this->dirty[id.index],
+                                   &this->observed[id.index], 1u << field,
+                                   PackedProperty<int>::Key{this, this->key_index(id.index, field)});
+    }
+
+    void erase_observers(uint32_t index)
+    {
+        for (uint32_t field = 0; this->observed[index] != 0 && field < PackedView::FIELD_COUNT; field++)
+        {
+            if (!(this->observed[index] & (1u << field)))
+            {
+                continue;
+            }
+            uint32_t key = this->key_index(index, (PackedView::Field)field);
+            if (field < PackedView::R)
+            {
+                ObserverSideTable<float>::global().erase({this, key});
+            }
+            else
+            {
+                ObserverSideTable<int>::global().erase({this, key});
+            }
+        }
+        this->observed[index] = 0;
+    }
+
+public:
+    ViewTable() = default;
+    ViewTable(const ViewTable &) = delete;
+    ViewTable &operator=(const ViewTable &) = delete;
+
+    ~ViewTable()
+    {
+        for (uint32_t index = 0; index < this->observed.size(); index++)
+        {
+            this->erase_observers(index);
+        }
+    }
+
+    /**
+     * @brief Adds a view with every value zeroed
+     *
+     * @return ViewId Handle to the view
+     */
+    ViewId create()
+    {
+        uint32_t index;
+        if (!this->free_indices.empty())
+        {
+            index = this->free_indices.back();
+            this->free_indices.pop_back();
+            // Odd generations are live and even ones free, so ids are only ever handed out once
+            this->generations[index]++;
+            for (auto &column : this->floats)
+            {
+                column[index] = 0.0f;
+            }
+            for (auto &column : this->ints)
+            {
+                column[index] = 0;
+            }
+            this->dirty[index] = 0;
+        }
+        else
+        {
+            index = (uint32_t)this->generations.size();
+            for (auto &column : this->floats)
+            {
+                column.push_back(0.0f);
+            }
+            for (auto &column : this->ints)
+            {
+                column.push_back(0);
+            }
+            this->dirty.push_back(0);
+            this->observed.push_back(0);
+            this->generations.push_back(1);
+        }
+        return ViewId{index, this->generations[index]};
+    }
+
+    /**
+     * @brief Removes a view and its observers, its index is reused by a later create
+     *
+     * @param id View to destroy
+     * @return true The view was destroyed
+     * @return false The handle was stale
+     */
+    bool destroy(ViewId id)
+    {
+        if (!this->alive(id))
+        {
+            return false;
+        }
+
+        this->erase_observers(id.index);
+        this->generations[id.index]++;
+        this->free_indices.push_back(id.index);
+        return true;
+    }
+
+    bool alive(ViewId id) const
+    {
+        return (id.generation & 1) && id.index < this->generations.size() &&
+               this->generations[id.index] == id.generation;
+    }
+
+    /**
+     * @return size_t Number of live views
+     */
+    size_t size() const
+    {
+        return this->generations.size() - this->free_indices.size();
+    }
+
+    /**
+     * @return size_t Length of every column, live views and reusable indices alike
+     */
+    size_t capacity() const
+    {
+        return this->generations.size();
+    }
+
+    PackedProperty<float> x(ViewId id) { return this->float_property(id, PackedView::X); }
+    PackedProperty<float> y(ViewId id) { return this->float_property(id, PackedView::Y); }
+    PackedProperty<float> width(ViewId id) { return this->float_property(id, PackedView::WIDTH); }
+    PackedProperty<float> height(ViewId id) { return this->float_property(id, PackedView::HEIGHT); }
+    PackedProperty<int> r(ViewId id) { return this->int_property(id, PackedView::R); }
+    PackedProperty<int> g(ViewId id) { return this->int_property(id, PackedView::G); }
+    PackedProperty<int> b(ViewId id) { return this->int_property(id, PackedView::B); }
+
+    /**
+     * @param field One of PackedView::X, Y, WIDTH or HEIGHT
+     * @return const float* Column of capacity() values
+     */
+    const float *float_column(PackedView::Field field) const
+    {
+        return this->floats[field].data();
+    }
+
+    /**
+     * @param field One of PackedView::R, G or B
+     * @return const int* Column of capacity() values
+     */
+    const int *int_column(PackedView::Field field) const
+    {
+        return this->ints[field - PackedView::R].data();
+    }
+
+    /**
+     * @brief Returns and clears a view's dirty bits
+     *
+     * @param id View to pull
+     * @return uint32_t View::DirtyBits of the properties written since the last call, 0 for a stale id
+     */
+    uint32_t take_dirty(ViewId id)
+    {
+        if (!this->alive(id))
+        {
+            return 0;
+        }
+        uint32_t bits = this->dirty[id.index];
+        this->dirty[id.index] = 0;
+        return bits;
+    }
+};
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "batch.h"
+#include "property.h"
+#include "worker_pool.h"
+
+/**
+ * @brief Spring towards a target, in the units of the animated property
+ *
+ * Stiffness and damping are per unit mass. The defaults are a quick, nearly
+ * critically damped response that settles in about half a second.
+ */
+struct SpringConfig
+{
+    // Restoring acceleration per unit of displacement, in 1/s^2
+    float stiffness = 170.0f;
+    // Velocity damping, in 1/s
+    float damping = 26.0f;
+    // Settled once slower than this, in units/s
+    float rest_speed = 0.05f;
+    // and closer to the target than this, in units
+    float rest_delta = 0.01f;
+};
+
+/**
+ * @brief Exponential slow-down from an initial velocity, as for a flick
+ *
+ * The value coasts towards start + velocity / friction.
+ */
+struct DecayConfig
+{
+    // Fraction of velocity lost per second is 1 - e^-friction
+    float friction = 2.0f;
+    // Settled once slower than this, in units/s
+    float rest_speed = 0.05f;
+};
+
+/**
+ * @brief Structure-of-arrays storage for spring and decay animations
+ *
+ * Every lane obeys a = stiffness * (target - x) - damping * v, which is a
+ * spring with non-zero stiffness and a pure decay without. Lanes are
+ * integrated with semi-implicit Euler at a fixed STEP_US, independent of the
+ * frame rate, and each frame writes the position interpolated between the last
+ * two steps. A lane retires as soon as it is slower than its rest speed and
+ * within its rest distance of the target, rather than after a fixed duration.
+ *
+ * Each property has at most one lane; springing it again keeps its position
+ * and velocity and only changes the target and configuration.
+ */
+class PhysicsAnimationStore : public AnimationBatch
+{
+public:
+    // 240 Hz, fine enough to keep stiff springs stable
+    static constexpr int64_t STEP_US = 4167;
+    // Steps simulated in one tick at most, so a stalled frame never causes a spiral of catch-up work
+    static constexpr int64_t MAX_STEPS = 32;
+
+private:
+    std::vector<float> position;
+    std::vector<float> previous;
+    std::vector<float> velocity;
+    std::vector<float> target;
+    std::vector<float> stiffness;
+    std::vector<float> damping;
+    std::vector<float> rest_speed;
+    std::vector<float> rest_delta;
+    std::vector<ObservableProperty<float> *> properties;
+
+    std::unordered_map<const ObservableProperty<float> *, uint32_t> lanes;
+
+    // Time the simulation has been advanced to, in microseconds
+    int64_t simulated = 0;
+
+    // Blend between previous and position written by the last tick
+    float rendered_alpha = 1.0f;
+
+    // Lanes per parallel chunk, each chunk runs every step of the tick while it is in cache
+    static constexpr size_t CHUNK_LANES = 1024;
+
+    AnimationWorkerPool *workers = nullptr;
+    int64_t pending_steps = 0;
+
+    void integrate(size_t first, size_t count, int64_t steps)
+    {
+        const float dt = (float)STEP_US * 1e-6f;
+        float *__restrict x = this->position.data() + first;
+        float *__restrict prev = this->previous.data() + first;
+        float *__restrict v = this->velocity.data() + first;
+        const float *__restrict goal = this->target.data() + first;
+        const float *__restrict k = this->stiffness.data() + first;
+        const float *__restrict c = this->damping.data() + first;
+
+        for (int64_t step = 0; step < steps; step++)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                prev[i] = x[i];
+                v[i] += (k[i] * (goal[i] - x[i]) - c[i] * v[i]) * dt;
+                x[i] += v[i] * dt;
+            }
+        }
+    }
+
+    static void integrate_chunk(void *store, size_t chunk)
+    {
+        PhysicsAnimationStore *self = static_cast<PhysicsAnimationStore *>(store);
+        size_t first = chunk * CHUNK_LANES;
+        self->integrate(first, std::min(CHUNK_LANES, self->properties.size() - first), self->pending_steps);
+    }
+
+    void remove(size_t lane)
+    {
+        size_t last = this->properties.size() - 1;
+        this->lanes.erase(this->properties[lane]);
+        if (lane != last)
+        {
+            this->position[lane] = this->position[last];
+            this->previous[lane] = this->previous[last];
+            this->velocity[lane] = this->velocity[last];
+            this->target[lane] = this->target[last];
+            this->stiffness[lane] = this->stiffness[last];
+            this->damping[lane] = this->damping[last];
+            this->rest_speed[lane] = this->rest_speed[last];
+            this->rest_delta[lane] = this->rest_delta[last];
+            this->properties[lane] = this->properties[last];
+            this->lanes[this->properties[lane]] = (uint32_t)lane;
+        }
+        this->position.pop_back();
+        this->previous.pop_back();
+        this->velocity.pop_back();
+        this->target.pop_back();
+        this->stiffness.pop_back();
+        this->damping.pop_back();
+        this->rest_speed.pop_back();
+        this->rest_delta.pop_back();
+        this->properties.pop_back();
+    }
+
+    size_t lane_for(ObservableProperty<float> *property, float from, float initial_velocity, int64_t now)
+    {
+        if (this->properties.empty())
+        {
+            this->simulated = now;
+        }
+
+        auto found = this->lanes.find(property);
+        if (found != this->lanes.end())
+        {
+            return found->second;
+        }
+
+        size_t lane = this->properties.size();
+        this->lanes.emplace(property, (uint32_t)lane);
+        this->position.push_back(from);
+        this->previous.push_back(from);
+        this->velocity.push_back(initial_velocity);
+        this->target.push_back(from);
+        this->stiffness.push_back(0.0f);
+        this->damping.push_back(0.0f);
+        this->rest_speed.push_back(0.0f);
+        this->rest_delta.push_back(0.0f);
+        this->properties.push_back(property);
+        return lane;
+    }
+
+public:
+    /**
+     * @brief Springs a property towards a target, keeping its motion if it already has a lane
+     *
+     * @param property Property to animate
+     * @param from Start value, ignored when the property already has a lane
+     * @param initial_velocity Start velocity in units/s, ignored when the property already has a lane
+     * @param to Target value
+     * @param config Spring parameters
+     * @param now Current time in microseconds
+     */
+    void spring(ObservableProperty<float> *property, float from, float initial_velocity, float to,
+                const SpringConfig &config, int64_t now)
+    {
+        size_t lane = this->lane_for(property, from, initial_velocity, now);
+        this->target[lane] = to;
+        this->stiffness[lane] = config.stiffness;
+        this->damping[lane] = config.damping;
+        this->rest_speed[lane] = config.rest_speed;
+        this->rest_delta[lane] = config.rest_delta;
+    }
+
+    /**
+     * @brief Lets a property coast to a stop from an initial velocity
+     *
+     * @param property Property to animate
+     * @param from Start value, ignored when the property already has a lane
+     * @param initial_velocity Velocity in units/s, replaces the lane's velocity if it has one
+     * @param config Decay parameters
+     * @param now Current time in microseconds
+     */
+    void decay(ObservableProperty<float> *property, float from, float initial_velocity, const DecayConfig &config,
+               int64_t now)
+    {
+        size_t lane = this->lane_for(property, from, initial_velocity, now);
+        this->velocity[lane] = initial_velocity;
+        this->stiffness[lane] = 0.0f;
+        this->damping[lane] = config.friction;
+        this->rest_speed[lane] = config.rest_speed;
+        // Any distance counts as settled, only the speed matters
+        this->rest_delta[lane] = INFINITY;
+    }
+
+    /**
+     * @return true The property has a lane
+     */
+    bool contains(const ObservableProperty<float> *property) const
+    {
+        return this->lanes.count(property) != 0;
+    }
+
+    /**
+     * @brief Removes a property's lane, leaving the property at its last written value
+     *
+     * @param property Property to stop animating
+     * @return true The property had a lane
+     */
+    bool cancel(const ObservableProperty<float> *property)
+    {
+        auto found = this->lanes.find(property);
+        if (found == this->lanes.end())
+        {
+            return false;
+        }
+        this->remove(found->second);
+        return true;
+    }
+
+    /**
+     * @brief Removes a property's lane, reporting its motion so another animation can take over
+     *
+     * @param property Property to release
+     * @param value Receives the lane's position as last written by tick
+     * @param speed Receives its velocity in units/s
+     * @return true The property had a lane
+     */
+    bool take(const ObservableProperty<float> *property, float &value, float &speed)
+    {
+        auto found = this->lanes.find(property);
+        if (found == this->lanes.end())
+        {
+            return false;
+        }
+
+        size_t lane = found->second;
+        float from = this->previous[lane];
+        value = from + (this->position[lane] - from) * this->rendered_alpha;
+        speed = this->velocity[lane];
+        this->remove(lane);
+        return true;
+    }
+
+    void tick(int64_t now) override
+    {
+        size_t count = this->properties.size();
+        this->completed = 0;
+        if (count == 0)
+        {
+            return;
+        }
+
+        int64_t steps = (now - this->simulated) / STEP_US;
+        if (steps > MAX_STEPS)
+        {
+            // Drop the backlog rather than simulating it
+            this->simulated = now - MAX_STEPS * STEP_US;
+            steps = MAX_STEPS;
+        }
+
+        if (steps > 0)
+        {
+            size_t chunks = (count + CHUNK_LANES - 1) / CHUNK_LANES;
+            this->pending_steps = steps;
+            if (this->workers && chunks > 1)
+            {
+                this->workers->run(chunks, &PhysicsAnimationStore::integrate_chunk, this);
+            }
+            else
+            {
+                for (size_t chunk = 0; chunk < chunks; chunk++)
+                {
+                    integrate_chunk(this, chunk);
+                }
+            }
+            this->simulated += steps * STEP_US;
+        }
+
+        // Render between the last two steps so motion stays smooth at any frame rate
+        float alpha = std::min(std::max((float)(now - this->simulated) / (float)STEP_US, 0.0f), 1.0f);
+        this->rendered_alpha = alpha;
+
+        // Write back on the calling thread and retire settled lanes, from the
+        // back so swapped-in lanes have already been visited. Dependents
+        // publish after the pass, as in FloatAnimationStore::tick
+        PropertyBatch::begin_write();
+        for (size_t lane = count; lane-- > 0;)
+        {
+            bool settled = std::fabs(this->velocity[lane]) < this->rest_speed[lane] &&
+                           std::fabs(this->target[lane] - this->position[lane]) < this->rest_delta[lane];
+            if (settled)
+            {
+                this->properties[lane]->store(this->stiffness[lane] != 0.0f ? this->target[lane]
+                                                                            : this->position[lane]);
+                this->remove(lane);
+                this->completed++;
+                continue;
+            }
+
+            float from = this->previous[lane];
+            this->properties[lane]->store(from + (this->position[lane] - from) * alpha);
+        }
+        PropertyBatch::end_write();
+    }
+
+    size_t size() const override
+    {
+        return this->properties.size();
+    }
+
+    void set_workers(AnimationWorkerPool *pool) override
+    {
+        this->workers = pool;
+    }
+};
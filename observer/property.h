@@ -0,0 +1,519 @@
+#pragma once
+
+#include "observer_list.h"
+
+#define UIFloat ObservableProperty<float>
+#define UIInt ObservableProperty<int>
+
+/**
+ * @brief Change policy that notifies on every write, the default
+ */
+struct AlwaysNotify
+{
+    template <typename T>
+    static constexpr bool unchanged(const T &, const T &)
+    {
+        return false;
+    }
+};
+
+/**
+ * @brief Change policy that drops writes comparing equal to the current value
+ */
+struct NotifyOnChange
+{
+    template <typename T>
+    static bool unchanged(const T &old, const T &current)
+    {
+        return old == current;
+    }
+};
+
+/**
+ * @brief Tolerance used by NotifyOutsideEpsilon, specialise for custom types
+ *
+ * @tparam T Property value type
+ */
+template <typename T>
+struct PropertyEpsilon
+{
+    static constexpr T value()
+    {
+        return T();
+    }
+};
+
+template <>
+struct PropertyEpsilon<float>
+{
+    static constexpr float value()
+    {
+        return 1e-4f;
+    }
+};
+
+template <>
+struct PropertyEpsilon<double>
+{
+    static constexpr double value()
+    {
+        return 1e-9;
+    }
+};
+
+/**
+ * @brief Change policy that drops writes within PropertyEpsilon<T> of the current value
+ */
+struct NotifyOutsideEpsilon
+{
+    template <typename T>
+    static bool unchanged(const T &old, const T &current)
+    {
+        return std::abs(current - old) <= PropertyEpsilon<T>::value();
+    }
+};
+
+/**
+ * @brief Scoped transaction that coalesces property notifications
+ *
+ * While a batch is open on the current thread, property writes store their
+ * value immediately but defer notification. On the outermost commit every
+ * written property notifies once, with the value it had before the batch and
+ * its final value, so a layout pass touching x, y, width and height of 10k
+ * views is one notification pass instead of 40k interleaved ones.
+ *
+ * Batches nest; only the outermost commit delivers. Unlike an immediate write,
+ * the property already holds its final value when a batched observer runs. A
+ * property written in a batch must outlive the commit.
+ */
+class PropertyBatch
+{
+private:
+    // Delivers one coalesced notification, carrying whatever state the write captured
+    typedef InlineFunction<void()> Pending;
+
+    static uint32_t &depth()
+    {
+        static thread_local uint32_t value = 0;
+        return value;
+    }
+
+    static std::vector<Pending> &pending()
+    {
+        static thread_local std::vector<Pending> value;
+        return value;
+    }
+
+    static uint32_t &delivery_depth()
+    {
+        static thread_local uint32_t value = 0;
+        return value;
+    }
+
+    static uint32_t &write_depth()
+    {
+        static thread_local uint32_t value = 0;
+        return value;
+    }
+
+public:
+    PropertyBatch()
+    {
+        begin_batch();
+    }
+
+    ~PropertyBatch()
+    {
+        commit();
+    }
+
+    PropertyBatch(const PropertyBatch &) = delete;
+    PropertyBatch &operator=(const PropertyBatch &) = delete;
+
+    /**
+     * @brief Opens a batch, deferring notifications until the matching commit
+     */
+    static void begin_batch()
+    {
+        depth()++;
+    }
+
+    /**
+     * @brief Closes a batch, delivering coalesced notifications if it was the outermost one
+     */
+    static void commit()
+    {
+        if (--depth() > 0)
+        {
+            return;
+        }
+
+        ANIMATION_PHASE("commit", commit_us);
+        deliver();
+    }
+
+    /**
+     * @brief Marks the start of an unbatched write's notification
+     *
+     * Flushes enqueued by its observers wait until end_write, once the write
+     * has been stored.
+     */
+    static void begin_write()
+    {
+        write_depth()++;
+    }
+
+    /**
+     * @brief Ends an unbatched write, delivering flushes its observers enqueued
+     */
+    static void end_write()
+    {
+        if (--write_depth() == 0 && !pending().empty() && depth() == 0 && delivery_depth() == 0)
+        {
+            deliver();
+        }
+    }
+
+    /**
+     * @return true A batch is open on the current thread
+     */
+    static bool active()
+    {
+        return depth() > 0;
+    }
+
+    /**
+     * @return true Flushes enqueued now run later on the current thread, at commit or end_write
+     */
+    static bool deferring()
+    {
+        return depth() > 0 || delivery_depth() > 0 || write_depth() > 0;
+    }
+
+    /**
+     * @brief Queues a property for delivery at commit, called once per property per batch
+     *
+     * @param property Property to flush
+     * @param flush Delivers the coalesced notification for property
+     */
+    static void enqueue(void *property, void (*flush)(void *))
+    {
+        pending().push_back(Pending([property, flush] { flush(property); }));
+    }
+
+    /**
+     * @brief Queues a callable for delivery at commit
+     *
+     * Lets a write carry its pre-batch value in the queue rather than in the
+     * property. Captures up to two pointers are stored without allocating.
+     *
+     * @param flush Delivers the coalesced notification
+     */
+    template <typename F>
+    static void enqueue(F flush)
+    {
+        pending().push_back(Pending(std::move(flush)));
+    }
+
+private:
+    static void deliver()
+    {
+        // Observers may open batches of their own, so deliver from a detached list
+        std::vector<Pending> round;
+        round.swap(pending());
+
+        // Flushes queued while delivering, such as computed properties settling
+        // after their inputs, go out in a further round of the same commit. The
+        // last swap hands the emptied capacity back for the next batch
+        delivery_depth()++;
+        while (!round.empty())
+        {
+            for (auto &flush : round)
+            {
+                flush();
+            }
+            round.clear();
+            round.swap(pending());
+        }
+        delivery_depth()--;
+    }
+};
+
+/**
+ * @brief Computed values derived from a property, marked dirty on every stored write
+ *
+ * Unlike an observer, a dependent is invalidated by store() itself, so it is
+ * marked on unobserved, batched, pull-mode and animation writes alike and never
+ * settles against a value about to be replaced. Empty until the first
+ * dependent registers; a copied property starts without dependents.
+ */
+class PropertyDependents
+{
+private:
+    struct Dependent
+    {
+        void *node;
+        void (*invalidate)(void *);
+    };
+
+    std::unique_ptr<std::vector<Dependent> > list;
+
+public:
+    PropertyDependents() = default;
+
+    PropertyDependents(const PropertyDependents &)
+    {
+    }
+
+    PropertyDependents &operator=(const PropertyDependents &)
+    {
+        return *this;
+    }
+
+    bool empty() const
+    {
+        return !this->list || this->list->empty();
+    }
+
+    /**
+     * @param node Dependent passed back to invalidate, must remove itself before it is destroyed
+     * @param invalidate Marks node dirty
+     */
+    void add(void *node, void (*invalidate)(void *))
+    {
+        if (!this->list)
+        {
+            this->list.reset(new std::vector<Dependent>());
+        }
+        this->list->push_back(Dependent{node, invalidate});
+    }
+
+    void remove(void *node)
+    {
+        if (this->list)
+        {
+            auto &items = *this->list;
+            items.erase(std::remove_if(items.begin(), items.end(),
+                                       [node](const Dependent &dependent)
+                                       { return dependent.node == node; }),
+                        items.end());
+        }
+    }
+
+    /**
+     * @brief Marks every dependent, notifications they schedule go out once all are marked
+     */
+    void invalidate() const
+    {
+        PropertyBatch::begin_write();
+        for (const Dependent &dependent : *this->list)
+        {
+            dependent.invalidate(dependent.node);
+        }
+        PropertyBatch::end_write();
+    }
+};
+
+/**
+ * @brief How an ObservableProperty reacts to writes
+ */
+enum class PropertyMode : uint8_t
+{
+    // Observers are called on every write
+    Push,
+    // Writes only bump the version and set the dirty bit, observers are skipped
+    Pull
+};
+
+/**
+ * @brief Value that calls its observers whenever it is assigned
+ *
+ * ChangePolicy decides which writes count as a change. A write the policy
+ * considers unchanged costs one compare: no observer is called and the stored
+ * value is left as is, so a run of sub-epsilon writes cannot drift away from
+ * what observers last saw.
+ *
+ * In PropertyMode::Pull a write skips observers entirely and only bumps the
+ * version counter and the dirty bit bound with track(), so a renderer can
+ * collect changes once per frame instead of reacting to each one.
+ *
+ * @tparam T Value type
+ * @tparam ChangePolicy AlwaysNotify, NotifyOnChange or NotifyOutsideEpsilon
+ */
+template <typename T, typename ChangePolicy = AlwaysNotify>
+struct ObservableProperty
+{
+    T value{};
+
+    // Bumped on every stored write, lets pull-based readers detect changes
+    uint32_t version = 0;
+
+    ObserverList<T> observers;
+
+    // Owner's dirty mask, see dirty_bit
+    uint32_t *dirty_mask = nullptr;
+
+    // ComputedProperty instances reading this one
+    PropertyDependents dependents;
+
+    // Bit or bits this property sets in dirty_mask
+    uint32_t dirty_bit = 0;
+    PropertyMode mode = PropertyMode::Push;
+
+    // A write of the open batch is queued, the queue holds the value from before the batch
+    bool batched = false;
+
+    ObservableProperty() = default;
+
+    /**
+     * @brief Copies the value and observers but not the dirty-mask binding
+     *
+     * A copy, such as a Point taken out of a View, is detached from its
+     * source's owner and marks nothing dirty until it is bound with track().
+     * A batched write still pending on the source stays with the source.
+     */
+    ObservableProperty(const ObservableProperty &other)
+        : value(other.value), version(other.version), observers(other.observers), dependents(other.dependents),
+          mode(other.mode)
+    {
+    }
+
+    /**
+     * @brief Copies the value and observers, keeping this property's own dirty-mask binding and batch state
+     */
+    ObservableProperty &operator=(const ObservableProperty &other)
+    {
+        this->value = other.value;
+        this->version = other.version;
+        this->observers = other.observers;
+        this->dependents = other.dependents;
+        this->mode = other.mode;
+        return *this;
+    }
+
+    /**
+     * @brief Propagates writes to an owner's dirty mask
+     *
+     * @param mask Mask in the owning object, must outlive the property binding
+     * @param bit Bit or bits set in mask on every write
+     */
+    void track(uint32_t *mask, uint32_t bit)
+    {
+        this->dirty_mask = mask;
+        this->dirty_bit = bit;
+    }
+
+    /**
+     * @brief Writes the value and marks it dirty without calling observers
+     *
+     * Used by animations, which write every frame and bypass observers.
+     * Dependents are still marked, see PropertyDependents.
+     *
+     * @param new_value Value to store
+     */
+    inline void store(const T new_value)
+    {
+        this->value = new_value;
+        this->version++;
+        if (this->dirty_mask)
+        {
+            *this->dirty_mask |= this->dirty_bit;
+        }
+        if (!this->dependents.empty())
+        {
+            this->dependents.invalidate();
+        }
+    }
+
+    /**
+     * @brief Delivers the coalesced notification queued by a batched write
+     *
+     * @param old Value before the first write of the batch
+     */
+    void flush_batch(const T &old)
+    {
+        this->batched = false;
+
+        if (!ChangePolicy::unchanged(old, this->value))
+        {
+            this->observers.notify(old, this->value);
+        }
+    }
+
+    inline void
+    operator=(const T new_value)
+    {
+        if (ChangePolicy::unchanged(this->value, new_value))
+        {
+            return;
+        }
+
+        if (this->mode == PropertyMode::Pull || this->observers.empty())
+        {
+            this->store(new_value);
+            return;
+        }
+
+        if (PropertyBatch::active())
+        {
+            if (!this->batched)
+            {
+                this->batched = true;
+                PropertyBatch::enqueue([this, old = this->value] { this->flush_batch(old); });
+            }
+            else
+            {
+                ANIMATION_STAT(notifications_coalesced, 1);
+            }
+            this->store(new_value);
+            return;
+        }
+
+        PropertyBatch::begin_write();
+        this->observers.notify(this->value, new_value);
+        this->store(new_value);
+        PropertyBatch::end_write();
+    }
+
+    /**
+     * @brief Observer will be called in the event that the backing value changes
+     *
+     * @param observer Lambda to be called, stored in place when its captures are small
+     * @return ObserverHandle Handle for remove_observer
+     */
+    template <typename F>
+    ObserverHandle add_observer(F observer)
+    {
+        return this->observers.add(std::move(observer));
+    }
+
+    /**
+     * @brief Stops an observer from being called, O(1)
+     *
+     * @param handle Handle returned by add_observer
+     * @return true The observer was removed
+     * @return false The handle was stale
+     */
+    bool remove_observer(ObserverHandle handle)
+    {
+        return this->observers.remove(handle);
+    }
+
+    /**
+     * @brief Adds an observer that is removed when the returned Subscription is destroyed
+     *
+     * @param observer Lambda to be called
+     * @return Subscription RAII handle, must not outlive the property
+     */
+    template <typename F>
+    Subscription subscribe(F observer)
+    {
+        ObserverHandle handle = this->observers.add(std::move(observer));
+        return Subscription(&this->observers, &ObserverList<T>::remove_thunk, handle);
+    }
+};
+
+#if OBSERVER_EXTERN_TEMPLATES
+extern template struct ObservableProperty<float>;
+extern template struct ObservableProperty<int>;
+#endif
@@ -0,0 +1,555 @@
+#pragma once
+
+#include "batch.h"
+#include "float_store.h"
+#include "group.h"
+#include "physics.h"
+#include "stats.h"
+
+template <typename A, typename Easing = Linear>
+class CompositeAnimation;
+
+/**
+ * @brief Owns every in-flight animation and advances them once per frame
+ *
+ * Animations are grouped into one contiguous batch per animation type, with
+ * float animations going to a structure-of-arrays store. A frame
+ * is a single pass over each batch, so thousands of concurrent animations cost
+ * one loop instead of one blocked thread each.
+ */
+class AnimationScheduler
+{
+private:
+    std::vector<std::unique_ptr<AnimationBatch> > batches;
+    AnimationWorkerPool *workers = nullptr;
+
+    static size_t next_batch_id()
+    {
+        static size_t counter = 0;
+        return counter++;
+    }
+
+    template <typename A>
+    static size_t batch_id()
+    {
+        static const size_t id = next_batch_id();
+        return id;
+    }
+
+    template <typename B>
+    B &batch()
+    {
+        size_t id = batch_id<B>();
+        if (id >= this->batches.size())
+        {
+            this->batches.resize(id + 1);
+        }
+        if (!this->batches[id])
+        {
+            this->batches[id].reset(new B());
+            this->batches[id]->set_workers(this->workers);
+        }
+        return static_cast<B &>(*this->batches[id]);
+    }
+
+    /**
+     * @return B* The batch of this type, or nullptr if nothing has created it yet
+     */
+    template <typename B>
+    B *existing_batch()
+    {
+        size_t id = batch_id<B>();
+        return id < this->batches.size() ? static_cast<B *>(this->batches[id].get()) : nullptr;
+    }
+
+    // The pooled animation last started on a property or aggregate, so the next one replaces it
+    struct PooledSlot
+    {
+        AnimationHandle handle;
+        bool (*cancel)(AnimationScheduler &, AnimationHandle);
+        bool (*alive)(AnimationScheduler &, AnimationHandle);
+    };
+
+    // Keyed by property for Animation and KeyframeAnimation, by target for CompositeAnimation
+    std::unordered_map<const void *, PooledSlot> property_slots;
+    std::unordered_map<const void *, PooledSlot> aggregate_slots;
+
+    template <typename A>
+    static bool cancel_pooled(AnimationScheduler &scheduler, AnimationHandle handle)
+    {
+        TypedAnimationBatch<A> *batch = scheduler.existing_batch<TypedAnimationBatch<A> >();
+        return batch && batch->animations.release(handle);
+    }
+
+    template <typename A>
+    static bool pooled_alive(AnimationScheduler &scheduler, AnimationHandle handle)
+    {
+        TypedAnimationBatch<A> *batch = scheduler.existing_batch<TypedAnimationBatch<A> >();
+        return batch && batch->animations.get(handle) != nullptr;
+    }
+
+    /**
+     * @brief Cancels the pooled animation recorded for key, if it is still running
+     *
+     * @return true An animation was cancelled
+     */
+    bool cancel_slot(std::unordered_map<const void *, PooledSlot> &slots, const void *key)
+    {
+        auto found = slots.find(key);
+        if (found == slots.end())
+        {
+            return false;
+        }
+        bool cancelled = found->second.cancel(*this, found->second.handle);
+        slots.erase(found);
+        return cancelled;
+    }
+
+    /**
+     * @brief Preps a pooled animation and records it as the one running on key, replacing any previous one
+     */
+    template <typename A>
+    AnimationHandle acquire(std::unordered_map<const void *, PooledSlot> &slots, const void *key, A animation)
+    {
+        this->cancel_slot(slots, key);
+        animation.prep();
+        AnimationHandle handle = this->batch<TypedAnimationBatch<A> >().animations.acquire(std::move(animation));
+        slots[key] = PooledSlot{handle, &AnimationScheduler::cancel_pooled<A>, &AnimationScheduler::pooled_alive<A>};
+        return handle;
+    }
+
+    // Drops records of retired animations once they outnumber the animations in flight
+    void prune_slots(std::unordered_map<const void *, PooledSlot> &slots)
+    {
+        if (slots.size() <= 2 * this->active() + 64)
+        {
+            return;
+        }
+        for (auto it = slots.begin(); it != slots.end();)
+        {
+            it = it->second.alive(*this, it->second.handle) ? std::next(it) : slots.erase(it);
+        }
+    }
+
+    /**
+     * @brief Stops the property's float lane and spring or decay
+     *
+     * @return true The property had either
+     */
+    bool cancel_lanes(const ObservableProperty<float> *property)
+    {
+        FloatAnimationStore *lanes = this->existing_batch<FloatAnimationStore>();
+        PhysicsAnimationStore *physics = this->existing_batch<PhysicsAnimationStore>();
+        bool cancelled = lanes && lanes->cancel(property);
+        return (physics && physics->cancel(property)) || cancelled;
+    }
+
+    /**
+     * @brief Moves a property's physics animation, if it has one, onto a float lane keeping its velocity
+     *
+     * @return true The property had a physics animation
+     */
+    bool hand_off_physics(ObservableProperty<float> *property, float target, int64_t duration, int64_t now)
+    {
+        PhysicsAnimationStore *physics = this->existing_batch<PhysicsAnimationStore>();
+        float value;
+        float speed;
+        if (!physics || !physics->take(property, value, speed))
+        {
+            return false;
+        }
+
+        // Physics velocity is per second, float lanes work in ms
+        this->batch<FloatAnimationStore>().animate_from(property, value, speed * 0.001f, target, duration, now);
+        return true;
+    }
+
+public:
+    /**
+     * @brief Spreads evaluation of large float batches over a worker pool
+     *
+     * Workers only compute; property writes still happen on the thread calling
+     * tick(). Pooled batches of other types stay on the calling thread.
+     *
+     * @param pool Pool that outlives the scheduler, or nullptr for single-threaded ticks
+     */
+    void set_workers(AnimationWorkerPool *pool)
+    {
+        this->workers = pool;
+        for (size_t i = 0; i < this->batches.size(); i++)
+        {
+            if (AnimationBatch *batch = this->batches[i].get())
+            {
+                batch->set_workers(pool);
+            }
+        }
+    }
+
+    /**
+     * @brief Preps an animation and hands it to the scheduler
+     *
+     * Any other animation of the same property, pooled or a float lane, is
+     * cancelled where it is, so competing animations never stack up.
+     *
+     * @param animation Animation to run, starting from the current time
+     * @return AnimationHandle Stable handle for find and cancel
+     */
+    template <typename T, typename Easing>
+    AnimationHandle add(Animation<T, Easing> animation)
+    {
+        if constexpr (std::is_same<T, float>::value)
+        {
+            this->cancel_lanes(animation.property);
+        }
+        ObservableProperty<T> *property = animation.property;
+        return this->acquire(this->property_slots, property, std::move(animation));
+    }
+
+    /**
+     * @param handle Handle returned by add
+     * @return Animation<T, Easing>* The in-flight animation, or nullptr once it has finished
+     */
+    template <typename T, typename Easing = Linear>
+    Animation<T, Easing> *find(AnimationHandle handle)
+    {
+        static_assert(!std::is_same<Animation<T, Easing>, Animation<float> >::value,
+                      "Linear float animations have no handle, use animating(property) or cancel(property)");
+        return this->batch<TypedAnimationBatch<Animation<T, Easing> > >().animations.get(handle);
+    }
+
+    /**
+     * @brief Stops an animation where it is
+     *
+     * @param handle Handle returned by add
+     * @return true The animation was still in flight
+     */
+    template <typename T, typename Easing = Linear>
+    bool cancel(AnimationHandle handle)
+    {
+        static_assert(!std::is_same<Animation<T, Easing>, Animation<float> >::value,
+                      "Linear float animations have no handle, use cancel(property)");
+        return this->batch<TypedAnimationBatch<Animation<T, Easing> > >().animations.release(handle);
+    }
+
+    /**
+     * @brief Starts a group of animations on one shared timeline
+     *
+     * Groups are controlled as a unit and do not replace other animations of
+     * their members' properties.
+     *
+     * @param group Group to run, starting from the current time
+     * @return AnimationHandle Stable handle for find_group
+     */
+    template <typename Easing>
+    AnimationHandle add(AnimationGroup<Easing> group)
+    {
+        group.prep();
+        return this->batch<TypedAnimationBatch<AnimationGroup<Easing> > >().animations.acquire(std::move(group));
+    }
+
+    /**
+     * @param handle Handle returned by add
+     * @return AnimationGroup<Easing>* The running group, to pause, seek or cancel it, or nullptr once it has finished
+     */
+    template <typename Easing = Linear>
+    AnimationGroup<Easing> *find_group(AnimationHandle handle)
+    {
+        return this->batch<TypedAnimationBatch<AnimationGroup<Easing> > >().animations.get(handle);
+    }
+
+    /**
+     * @brief Preps a keyframe animation and hands it to the scheduler
+     *
+     * Replaces any other animation of the same property, as add does for Animation.
+     *
+     * @param animation Animation to run, starting from the current time; one with an empty track retires on the next tick
+     * @return AnimationHandle Stable handle for find_keyframes
+     */
+    template <typename T>
+    AnimationHandle add(KeyframeAnimation<T> animation)
+    {
+        if constexpr (std::is_same<T, float>::value)
+        {
+            this->cancel_lanes(animation.property);
+        }
+        ObservableProperty<T> *property = animation.property;
+        return this->acquire(this->property_slots, property, std::move(animation));
+    }
+
+    /**
+     * @param handle Handle returned by add
+     * @return KeyframeAnimation<T>* The in-flight animation, for example to seek it, or nullptr once it has finished
+     */
+    template <typename T>
+    KeyframeAnimation<T> *find_keyframes(AnimationHandle handle)
+    {
+        return this->batch<TypedAnimationBatch<KeyframeAnimation<T> > >().animations.get(handle);
+    }
+
+    /**
+     * @brief Preps an aggregate animation and hands it to the scheduler
+     *
+     * Replaces any other aggregate animation of the same target. Animations of
+     * the target's individual properties are left running. A Color animates
+     * as RGBA8 and has every channel clamped to [0, 255] from its first frame,
+     * see AggregateTraits<Color>.
+     *
+     * @param animation Animation to run, starting from the current time
+     * @return AnimationHandle Stable handle for find_composite and cancel_composite
+     */
+    template <typename A, typename Easing>
+    AnimationHandle add(CompositeAnimation<A, Easing> animation)
+    {
+        A *target = animation.target;
+        return this->acquire(this->aggregate_slots, target, std::move(animation));
+    }
+
+    /**
+     * @param handle Handle returned by add
+     * @return CompositeAnimation<A, Easing>* The in-flight animation, or nullptr once it has finished
+     */
+    template <typename A, typename Easing = Linear>
+    CompositeAnimation<A, Easing> *find_composite(AnimationHandle handle)
+    {
+        return this->batch<TypedAnimationBatch<CompositeAnimation<A, Easing> > >().animations.get(handle);
+    }
+
+    /**
+     * @brief Stops an aggregate animation where it is
+     *
+     * @param handle Handle returned by add
+     * @return true The animation was still in flight
+     */
+    template <typename A, typename Easing = Linear>
+    bool cancel_composite(AnimationHandle handle)
+    {
+        return this->batch<TypedAnimationBatch<CompositeAnimation<A, Easing> > >().animations.release(handle);
+    }
+
+    /**
+     * @brief Preps a linear float animation and stores it in the SIMD batch
+     *
+     * Retargets the property's in-flight animation if it has one, and cancels
+     * a pooled animation of it. Lanes are addressed by their property rather
+     * than a handle, see animating and cancel. Float animations with other
+     * easings run in their own pooled batch.
+     *
+     * @param animation Animation to run, starting from the current time
+     */
+    void add(Animation<float> animation)
+    {
+        this->cancel_slot(this->property_slots, animation.property);
+        animation.prep();
+        if (!this->hand_off_physics(animation.property, animation.end, animation.duration,
+                                    animation.get_start_time()))
+        {
+            this->batch<FloatAnimationStore>().add(animation);
+        }
+    }
+
+    /**
+     * @brief Animates a float property to a target, keeping one animation per property
+     *
+     * If the property is already animating, its animation is retargeted from
+     * the current value and velocity instead of starting a second one. That
+     * includes taking over from a spring or decay.
+     *
+     * @param property Property to animate
+     * @param target End value
+     * @param duration Duration in ms
+     */
+    void animate_to(ObservableProperty<float> *property, float target, int64_t duration)
+    {
+        int64_t now = AnimationCore::start_time();
+        this->cancel_slot(this->property_slots, property);
+        if (!this->hand_off_physics(property, target, duration, now))
+        {
+            this->batch<FloatAnimationStore>().animate_to(property, property->value, target, duration, now);
+        }
+    }
+
+    /**
+     * @return true The property has a float lane or a spring or decay in flight
+     */
+    bool animating(const ObservableProperty<float> *property)
+    {
+        FloatAnimationStore *lanes = this->existing_batch<FloatAnimationStore>();
+        PhysicsAnimationStore *physics = this->existing_batch<PhysicsAnimationStore>();
+        return (lanes && lanes->contains(property)) || (physics && physics->contains(property));
+    }
+
+    /**
+     * @brief Stops the property's animation where it is
+     *
+     * Covers float lanes, springs and decays as well as the property's pooled
+     * Animation or KeyframeAnimation. Group members are cancelled with their group.
+     *
+     * @param property Property to stop animating
+     * @return true The property was animating
+     */
+    bool cancel(const ObservableProperty<float> *property)
+    {
+        bool cancelled = this->cancel_slot(this->property_slots, property);
+        return this->cancel_lanes(property) || cancelled;
+    }
+
+    /**
+     * @brief Springs a float property towards a target
+     *
+     * A property that is already springing keeps its position and velocity and
+     * only changes target, and one with a timed float animation continues from
+     * that animation's value and velocity. A pooled animation of the property
+     * is cancelled. The spring retires once it settles.
+     *
+     * @param property Property to animate
+     * @param target Value the spring pulls towards
+     * @param config Spring parameters
+     */
+    void spring_to(ObservableProperty<float> *property, float target, const SpringConfig &config = SpringConfig())
+    {
+        int64_t now = AnimationCore::start_time();
+        this->cancel_slot(this->property_slots, property);
+        float value = property->value;
+        float slope = 0.0f;
+        if (FloatAnimationStore *lanes = this->existing_batch<FloatAnimationStore>())
+        {
+            lanes->take(property, now, value, slope);
+        }
+
+        // Float lanes report velocity per ms, physics works per second
+        this->batch<PhysicsAnimationStore>().spring(property, value, slope * 1000.0f, target, config, now);
+    }
+
+    /**
+     * @brief Lets a float property coast to a stop, as after a flick
+     *
+     * Replaces any timed, pooled or spring animation of the property, starting
+     * from its current value.
+     *
+     * @param property Property to animate
+     * @param velocity Initial velocity in units per second
+     * @param config Decay parameters
+     */
+    void decay(ObservableProperty<float> *property, float velocity, const DecayConfig &config = DecayConfig())
+    {
+        int64_t now = AnimationCore::start_time();
+        this->cancel_slot(this->property_slots, property);
+        float value = property->value;
+        float slope;
+        if (FloatAnimationStore *lanes = this->existing_batch<FloatAnimationStore>())
+        {
+            lanes->take(property, now, value, slope);
+        }
+
+        this->batch<PhysicsAnimationStore>().decay(property, value, velocity, config, now);
+    }
+
+    /**
+     * @brief Appends the state of every in-flight animation in the float SIMD batch
+     *
+     * Covers animations added as Animation<float> with Linear easing and through
+     * animate_to. Pooled batches of other types are not exported.
+     *
+     * @param now Time in microseconds elapsed times are measured against
+     * @param out Receives one entry per animation
+     */
+    void export_float_animations(int64_t now, std::vector<FloatLaneState> &out)
+    {
+        this->batch<FloatAnimationStore>().export_lanes(now, out);
+    }
+
+    /**
+     * @brief Resumes an animation exported by export_float_animations, without firing observers
+     *
+     * Replaces whatever animation the property already has, including a spring or decay.
+     *
+     * @param state Exported animation, its property must be alive
+     * @param now Time in microseconds the animation's elapsed time is relative to
+     */
+    void import_float_animation(const FloatLaneState &state, int64_t now)
+    {
+        this->cancel(state.property);
+        this->batch<FloatAnimationStore>().import_lane(state, now);
+    }
+
+    /**
+     * @brief Advances every active animation by one frame
+     *
+     * @param now Frame timestamp in microseconds, see AnimationCore::begin_frame
+     */
+    void tick(int64_t now)
+    {
+        ANIMATION_PHASE("animation", animation_us);
+
+        // Computed dependents of animated properties publish once every batch
+        // has committed, so their observers may add batches or cancel animations.
+        // on_update runs inside a batch's tick and may create a batch too, so the
+        // list is walked by index: its storage can move, the batches never do.
+        PropertyBatch::begin_write();
+        for (size_t i = 0; i < this->batches.size(); i++)
+        {
+            if (AnimationBatch *batch = this->batches[i].get())
+            {
+                batch->tick(now);
+            }
+        }
+        PropertyBatch::end_write();
+        ANIMATION_STAT(active_animations, this->active());
+        this->prune_slots(this->property_slots);
+        this->prune_slots(this->aggregate_slots);
+    }
+
+    /**
+     * @return size_t Number of animations that completed and were retired by the last tick
+     */
+    size_t completed_this_frame() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < this->batches.size(); i++)
+        {
+            if (AnimationBatch *batch = this->batches[i].get())
+            {
+                count += batch->completed;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @return size_t Number of animations still in flight across all batches
+     */
+    size_t active() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < this->batches.size(); i++)
+        {
+            if (AnimationBatch *batch = this->batches[i].get())
+            {
+                count += batch->size();
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @return size_t Animations that still need frames: active() less those, such as paused
+     *         groups, that were idle on the last tick
+     */
+    size_t running() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < this->batches.size(); i++)
+        {
+            if (AnimationBatch *batch = this->batches[i].get())
+            {
+                count += batch->size() - batch->idle;
+            }
+        }
+        return count;
+    }
+};
+
+#if OBSERVER_EXTERN_TEMPLATES
+extern template class TypedAnimationBatch<Animation<float> >;
+extern template class TypedAnimationBatch<Animation<int> >;
+#endif
@@ -0,0 +1,423 @@
+#pragma once
+
+#include "packed_view.h"
+#include "scheduler.h"
+
+/**
+ * @brief Start of a ViewSnapshot image, followed by its view and animation records
+ */
+struct SnapshotHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    // Written as ViewSnapshot::ENDIAN_MARK, reads back differently on a foreign-endian machine
+    uint32_t byte_order;
+    uint32_t view_count;
+    uint32_t animation_count;
+    uint32_t reserved;
+};
+
+/**
+ * @brief Values of one View, in View::DirtyBits order
+ */
+struct ViewRecord
+{
+    float x;
+    float y;
+    float width;
+    float height;
+    int32_t r;
+    int32_t g;
+    int32_t b;
+    // ViewSnapshot::LIVE for a live view, 0 for a reusable ViewTable index
+    uint32_t flags;
+};
+
+/**
+ * @brief One in-flight float animation, addressed by view index and PackedView::Field
+ */
+struct AnimationRecord
+{
+    uint32_t view;
+    uint32_t field;
+    float start;
+    float end;
+    float velocity;
+    // Time since the animation started, in ms
+    float elapsed;
+    float inv_duration;
+    uint32_t reserved;
+};
+
+/**
+ * @brief Flat binary snapshot of View values and in-flight float animations
+ *
+ * The image is a SnapshotHeader followed by arrays of plain records in native
+ * byte order, so a memory-mapped file is read in place with no parsing or
+ * allocation. Restoring writes values with store(): observers do not fire,
+ * while dirty bits are set so the next frame redraws and ComputedProperty
+ * dependents are marked to recompute on their next read.
+ */
+class ViewSnapshot
+{
+public:
+    static constexpr uint32_t MAGIC = 0x5653424f;
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t ENDIAN_MARK = 0x01020304;
+    static constexpr uint32_t LIVE = 1;
+
+private:
+    static ObservableProperty<float> *float_field(View &view, uint32_t field)
+    {
+        switch (field)
+        {
+        case PackedView::X:
+            return &view.frame.position.x;
+        case PackedView::Y:
+            return &view.frame.position.y;
+        case PackedView::WIDTH:
+            return &view.frame.size.width;
+        case PackedView::HEIGHT:
+            return &view.frame.size.height;
+        default:
+            return nullptr;
+        }
+    }
+
+    static bool read_header(const void *data, size_t size, SnapshotHeader &header)
+    {
+        if (size < sizeof(SnapshotHeader))
+        {
+            return false;
+        }
+
+        std::memcpy(&header, data, sizeof(header));
+        return header.magic == MAGIC && header.version == VERSION && header.byte_order == ENDIAN_MARK &&
+               size >= sizeof(SnapshotHeader) + (size_t)header.view_count * sizeof(ViewRecord) +
+                           (size_t)header.animation_count * sizeof(AnimationRecord);
+    }
+
+public:
+    /**
+     * @brief Captures views and, optionally, the scheduler's float animations targeting them
+     *
+     * @param views Views to capture, restored later in the same order
+     * @param count Number of views
+     * @param scheduler Scheduler whose float animations are captured, or nullptr
+     * @param now Time in microseconds animation progress is measured against
+     * @return std::vector<unsigned char> Snapshot image
+     */
+    static std::vector<unsigned char> capture(View *const *views, size_t count, AnimationScheduler *scheduler = nullptr,
+                                              int64_t now = AnimationCore::start_time())
+    {
+        std::vector<AnimationRecord> animations;
+        if (scheduler)
+        {
+            std::vector<FloatLaneState> lanes;
+            scheduler->export_float_animations(now, lanes);
+
+            if (!lanes.empty())
+            {
+                // Map animated properties back to their view and field
+                std::unordered_map<const ObservableProperty<float> *, std::pair<uint32_t, uint32_t> > owners;
+                owners.reserve(count * 4);
+                for (size_t i = 0; i < count; i++)
+                {
+                    for (uint32_t field = PackedView::X; field <= PackedView::HEIGHT; field++)
+                    {
+                        owners.emplace(float_field(*views[i], field), std::make_pair((uint32_t)i, field));
+                    }
+                }
+
+                for (const FloatLaneState &lane : lanes)
+                {
+                    auto owner = owners.find(lane.property);
+                    if (owner != owners.end())
+                    {
+                        animations.push_back(AnimationRecord{owner->second.first, owner->second.second, lane.start,
+                                                             lane.end, lane.velocity, lane.elapsed,
+                                                             lane.inv_duration, 0});
+                    }
+                }
+            }
+        }
+
+        std::vector<unsigned char> image(sizeof(SnapshotHeader) + count * sizeof(ViewRecord) +
+                                         animations.size() * sizeof(AnimationRecord));
+
+        SnapshotHeader header = {MAGIC, VERSION, ENDIAN_MARK, (uint32_t)count, (uint32_t)animations.size(), 0};
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        ViewRecord *records = reinterpret_cast<ViewRecord *>(image.data() + sizeof(SnapshotHeader));
+        for (size_t i = 0; i < count; i++)
+        {
+            const View &view = *views[i];
+            records[i] = ViewRecord{view.frame.position.x.value, view.frame.position.y.value,
+                                    view.frame.size.width.value, view.frame.size.height.value,
+                                    view.color.r.value, view.color.g.value, view.color.b.value, LIVE};
+        }
+
+        if (!animations.empty())
+        {
+            std::memcpy(records + count, animations.data(), animations.size() * sizeof(AnimationRecord));
+        }
+        return image;
+    }
+
+    /**
+     * @brief Restores a snapshot into views laid out as they were captured
+     *
+     * @param data Snapshot image, for example MappedSnapshot::data()
+     * @param size Image size in bytes
+     * @param views Views to restore into, in capture order
+     * @param count Number of views, must match the snapshot
+     * @param scheduler Scheduler to resume captured animations on, or nullptr to drop them
+     * @param now Time in microseconds animation progress resumes from
+     * @return true Restored
+     * @return false The image is truncated, from another version or byte order, or for a different view count
+     */
+    static bool restore(const void *data, size_t size, View *const *views, size_t count,
+                        AnimationScheduler *scheduler = nullptr, int64_t now = AnimationCore::start_time())
+    {
+        SnapshotHeader header;
+        if (!read_header(data, size, header) || header.view_count != count)
+        {
+            return false;
+        }
+
+        const ViewRecord *records =
+            reinterpret_cast<const ViewRecord *>(static_cast<const unsigned char *>(data) + sizeof(SnapshotHeader));
+        for (size_t i = 0; i < count; i++)
+        {
+            View &view = *views[i];
+            const ViewRecord &record = records[i];
+            view.frame.position.x.store(record.x);
+            view.frame.position.y.store(record.y);
+            view.frame.size.width.store(record.width);
+            view.frame.size.height.store(record.height);
+            view.color.r.store(record.r);
+            view.color.g.store(record.g);
+            view.color.b.store(record.b);
+        }
+
+        if (scheduler)
+        {
+            const AnimationRecord *animations = reinterpret_cast<const AnimationRecord *>(records + count);
+            for (uint32_t i = 0; i < header.animation_count; i++)
+            {
+                const AnimationRecord &record = animations[i];
+                ObservableProperty<float> *property =
+                    record.view < count ? float_field(*views[record.view], record.field) : nullptr;
+                if (property)
+                {
+                    scheduler->import_float_animation(FloatLaneState{property, record.start, record.end,
+                                                                     record.velocity, record.elapsed,
+                                                                     record.inv_duration},
+                                                      now);
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Captures every index of a ViewTable, live or reusable
+     *
+     * @param table Table to capture
+     * @return std::vector<unsigned char> Snapshot image without animations
+     */
+    static std::vector<unsigned char> capture(const ViewTable &table)
+    {
+        size_t count = table.capacity();
+        std::vector<unsigned char> image(sizeof(SnapshotHeader) + count * sizeof(ViewRecord));
+
+        SnapshotHeader header = {MAGIC, VERSION, ENDIAN_MARK, (uint32_t)count, 0, 0};
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        ViewRecord *records = reinterpret_cast<ViewRecord *>(image.data() + sizeof(SnapshotHeader));
+        for (size_t i = 0; i < count; i++)
+        {
+            records[i] = ViewRecord{table.floats[PackedView::X][i], table.floats[PackedView::Y][i],
+                                    table.floats[PackedView::WIDTH][i], table.floats[PackedView::HEIGHT][i],
+                                    table.ints[0][i], table.ints[1][i], table.ints[2][i], LIVE};
+        }
+        for (uint32_t index : table.free_indices)
+        {
+            records[index].flags = 0;
+        }
+        return image;
+    }
+
+    /**
+     * @brief Restores a table image into an empty ViewTable, column by column
+     *
+     * Views keep their captured indices and restart at generation 1 for live
+     * views, so ViewIds of the form {index, 1} address them. Every restored
+     * view is marked fully dirty.
+     *
+     * @param data Snapshot image
+     * @param size Image size in bytes
+     * @param table Table with no views
+     * @return true Restored
+     * @return false The image is invalid or the table is not empty
+     */
+    static bool restore(const void *data, size_t size, ViewTable &table)
+    {
+        SnapshotHeader header;
+        if (!read_header(data, size, header) || table.capacity() != 0)
+        {
+            return false;
+        }
+
+        size_t count = header.view_count;
+        const ViewRecord *records =
+            reinterpret_cast<const ViewRecord *>(static_cast<const unsigned char *>(data) + sizeof(SnapshotHeader));
+
+        for (auto &column : table.floats)
+        {
+            column.resize(count);
+        }
+        for (auto &column : table.ints)
+        {
+            column.resize(count);
+        }
+        table.dirty.assign(count, View::DIRTY_FRAME | View::DIRTY_COLOR);
+        table.observed.assign(count, 0);
+        table.generations.assign(count, 1);
+
+        float *x = table.floats[PackedView::X].data();
+        float *y = table.floats[PackedView::Y].data();
+        float *width = table.floats[PackedView::WIDTH].data();
+        float *height = table.floats[PackedView::HEIGHT].data();
+        int *r = table.ints[0].data();
+        int *g = table.ints[1].data();
+        int *b = table.ints[2].data();
+        for (size_t i = 0; i < count; i++)
+        {
+            const ViewRecord &record = records[i];
+            x[i] = record.x;
+            y[i] = record.y;
+            width[i] = record.width;
+            height[i] = record.height;
+            r[i] = record.r;
+            g[i] = record.g;
+            b[i] = record.b;
+        }
+
+        for (size_t i = count; i-- > 0;)
+        {
+            if (!(records[i].flags & LIVE))
+            {
+                table.generations[i] = 2;
+                table.free_indices.push_back((uint32_t)i);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Writes an image captured by capture() to a file
+     *
+     * @param path File to create or replace
+     * @param image Snapshot image
+     * @return true Written
+     */
+    static bool save(const char *path, const std::vector<unsigned char> &image)
+    {
+        FILE *file = std::fopen(path, "wb");
+        if (!file)
+        {
+            return false;
+        }
+        bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+        return std::fclose(file) == 0 && written;
+    }
+};
+
+/**
+ * @brief Read-only view of a snapshot file, memory mapped where POSIX mmap is available
+ *
+ * Other platforms read the file into memory instead. The mapping is released
+ * when the object is destroyed.
+ */
+class MappedSnapshot
+{
+private:
+    const unsigned char *bytes = nullptr;
+    size_t length = 0;
+    std::vector<unsigned char> fallback;
+
+public:
+    /**
+     * @param path Snapshot file written by ViewSnapshot::save
+     */
+    explicit MappedSnapshot(const char *path)
+    {
+#if OBSERVER_HAS_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *mapped = ::mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                this->bytes = static_cast<const unsigned char *>(mapped);
+                this->length = (size_t)info.st_size;
+            }
+        }
+        ::close(fd);
+#else
+        FILE *file = std::fopen(path, "rb");
+        if (!file)
+        {
+            return;
+        }
+
+        unsigned char chunk[65536];
+        size_t read;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            this->fallback.insert(this->fallback.end(), chunk, chunk + read);
+        }
+        std::fclose(file);
+        this->bytes = this->fallback.data();
+        this->length = this->fallback.size();
+#endif
+    }
+
+    MappedSnapshot(const MappedSnapshot &) = delete;
+    MappedSnapshot &operator=(const MappedSnapshot &) = delete;
+
+    ~MappedSnapshot()
+    {
+#if OBSERVER_HAS_MMAP
+        if (this->bytes)
+        {
+            ::munmap(const_cast<unsigned char *>(this->bytes), this->length);
+        }
+#endif
+    }
+
+    /**
+     * @return true The file was opened and is not empty
+     */
+    bool valid() const
+    {
+        return this->bytes != nullptr;
+    }
+
+    const void *data() const
+    {
+        return this->bytes;
+    }
+
+    size_t size() const
+    {
+        return this->length;
+    }
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "common.h"
+
+#ifndef OBSERVER_INSTRUMENTATION
+#define OBSERVER_INSTRUMENTATION 0
+#endif
+
+/**
+ * @brief A completed span of work, in the shape Chrome's trace viewer and Perfetto expect
+ */
+struct TraceEvent
+{
+    const char *name;
+    int64_t start_us;
+    int64_t duration_us;
+};
+
+/**
+ * @brief Receives every phase span recorded while instrumentation is enabled
+ */
+typedef void (*TraceHook)(const TraceEvent &event, void *context);
+
+/**
+ * @brief Counters and phase timings for a single frame
+ */
+struct FrameStats
+{
+    uint64_t active_animations = 0;
+    uint64_t observer_callbacks = 0;
+    uint64_t notifications_coalesced = 0;
+    int64_t animation_us = 0;
+    int64_t commit_us = 0;
+    int64_t dispatch_us = 0;
+    int64_t frame_us = 0;
+};
+
+/**
+ * @brief Per-frame instrumentation for the thread that drives frames
+ *
+ * Only compiled in when OBSERVER_INSTRUMENTATION is non-zero; otherwise the
+ * ANIMATION_STAT and ANIMATION_PHASE macros expand to nothing and the hot
+ * paths carry no counters at all. Frames are delimited by
+ * AnimationCore::begin_frame and AnimationCore::end_frame.
+ */
+class AnimationStats
+{
+public:
+    static constexpr size_t HISTORY = 512;
+
+private:
+    struct State
+    {
+        FrameStats current;
+        FrameStats last;
+        int64_t frame_start = 0;
+        int64_t history[HISTORY] = {};
+        size_t recorded = 0;
+        TraceHook hook = nullptr;
+        void *hook_context = nullptr;
+    };
+
+    // Per thread, so counters bumped off the UI thread never race with it
+    static State &state()
+    {
+        static thread_local State value;
+        return value;
+    }
+
+    static std::atomic<uint64_t> &cross_thread_coalesced()
+    {
+        static std::atomic<uint64_t> value{0};
+        return value;
+    }
+
+public:
+    static int64_t clock_us()
+    {
+        return duration_cast<microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @return FrameStats& Counters of the frame in progress
+     */
+    static FrameStats &current()
+    {
+        return state().current;
+    }
+
+    /**
+     * @return const FrameStats& Counters of the most recently completed frame
+     */
+    static const FrameStats &last()
+    {
+        return state().last;
+    }
+
+    /**
+     * @brief Counts a write coalesced by an AtomicProperty, safe from any thread
+     */
+    static void add_cross_thread_coalesced()
+    {
+        cross_thread_coalesced().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void begin_frame(int64_t timestamp_us)
+    {
+        State &s = state();
+        s.current = FrameStats{};
+        s.frame_start = timestamp_us;
+    }
+
+    /**
+     * @brief Closes the frame, records its duration and emits a "frame" trace event
+     *
+     * @param timestamp_us Time the frame's work finished, in microseconds
+     */
+    static void end_frame(int64_t timestamp_us)
+    {
+        State &s = state();
+        s.current.notifications_coalesced += cross_thread_coalesced().exchange(0, std::memory_order_relaxed);
+        s.current.frame_us = timestamp_us - s.frame_start;
+        s.history[s.recorded % HISTORY] = s.current.frame_us;
+        s.recorded++;
+        s.last = s.current;
+        trace("frame", s.frame_start, s.current.frame_us);
+    }
+
+    /**
+     * @brief Frame duration percentile over the last HISTORY frames
+     *
+     * @param percentile In [0, 1], e.g. 0.5 for p50 and 0.99 for p99
+     * @return int64_t Frame duration in microseconds, 0 before the first frame
+     */
+    static int64_t frame_percentile(double percentile)
+    {
+        State &s = state();
+        size_t count = std::min(s.recorded, HISTORY);
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        int64_t sorted[HISTORY];
+        std::copy(s.history, s.history + count, sorted);
+        size_t rank = (size_t)(percentile * (count - 1) + 0.5);
+        std::nth_element(sorted, sorted + rank, sorted + count);
+        return sorted[rank];
+    }
+
+    /**
+     * @brief Routes the calling thread's phase spans to a trace writer, nullptr disables tracing
+     *
+     * @param hook Called for every completed span
+     * @param context Passed through to the hook
+     */
+    static void set_trace_hook(TraceHook hook, void *context)
+    {
+        state().hook = hook;
+        state().hook_context = context;
+    }
+
+    static void trace(const char *name, int64_t start_us, int64_t duration_us)
+    {
+        State &s = state();
+        if (s.hook)
+        {
+            s.hook(TraceEvent{name, start_us, duration_us}, s.hook_context);
+        }
+    }
+};
+
+/**
+ * @brief Adds the scope's duration to a FrameStats field and traces it
+ */
+class ScopedPhase
+{
+private:
+    const char *name;
+    int64_t &accumulator;
+    int64_t start;
+
+public:
+    ScopedPhase(const char *name, int64_t &accumulator)
+        : name(name), accumulator(accumulator), start(AnimationStats::clock_us())
+    {
+    }
+
+    ScopedPhase(const ScopedPhase &) = delete;
+    ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+    ~ScopedPhase()
+    {
+        int64_t duration = AnimationStats::clock_us() - this->start;
+        this->accumulator += duration;
+        AnimationStats::trace(this->name, this->start, duration);
+    }
+};
+
+/**
+ * @brief Buffers trace events and writes them as Chrome trace JSON
+ *
+ * The output loads in chrome://tracing and ui.perfetto.dev. Install with
+ * AnimationStats::set_trace_hook(&ChromeTraceWriter::record, &writer).
+ */
+class ChromeTraceWriter
+{
+private:
+    std::vector<TraceEvent> events;
+
+public:
+    static void record(const TraceEvent &event, void *context)
+    {
+        static_cast<ChromeTraceWriter *>(context)->events.push_back(event);
+    }
+
+    size_t size() const
+    {
+        return this->events.size();
+    }
+
+    void write(std::ostream &out) const
+    {
+        out << "{\"traceEvents\":[";
+        for (size_t i = 0; i < this->events.size(); i++)
+        {
+            const TraceEvent &event = this->events[i];
+            out << (i ? "," : "") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                << ",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us << "}";
+        }
+        out << "]}\n";
+    }
+};
+
+#if OBSERVER_INSTRUMENTATION
+#define ANIMATION_STAT(field, n) (AnimationStats::current().field += (n))
+#define ANIMATION_PHASE(name, field) ScopedPhase animation_phase_##field(name, AnimationStats::current().field)
+#else
+#define ANIMATION_STAT(field, n) ((void)0)
+#define ANIMATION_PHASE(name, field) ((void)0)
+#endif
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "containers.h"
+#include "stats.h"
+
+#ifndef OBSERVER_TRACE_ENABLED
+#ifdef NDEBUG
+#define OBSERVER_TRACE_ENABLED 0
+#else
+#define OBSERVER_TRACE_ENABLED 1
+#endif
+#endif
+
+/**
+ * @brief One diagnostic line, kept unformatted until the flusher thread writes it
+ */
+struct TraceRecord
+{
+    // Must outlive the flush, in practice a string literal
+    const char *label;
+    double old_value;
+    double new_value;
+    int64_t timestamp_us;
+};
+
+/**
+ * @brief Destination for flushed trace records, called from the flusher thread
+ */
+class TraceSink
+{
+public:
+    virtual ~TraceSink() = default;
+    virtual void write(const TraceRecord *records, size_t count) = 0;
+};
+
+/**
+ * @brief Formats records as "label: old -> new" lines on a stream
+ */
+class StreamTraceSink : public TraceSink
+{
+private:
+    std::ostream &out;
+
+public:
+    explicit StreamTraceSink(std::ostream &out) : out(out) {}
+
+    void write(const TraceRecord *records, size_t count) override
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            this->out << records[i].label << ": " << records[i].old_value << " -> " << records[i].new_value << '\n';
+        }
+        this->out.flush();
+    }
+};
+
+/**
+ * @brief Lock-free trace buffer drained into a TraceSink by a background thread
+ *
+ * record() is callable from any thread and costs a relaxed load when no sink
+ * is installed, or a push into a bounded MpscRing otherwise. Formatting and
+ * I/O happen on the flusher thread. Records arriving while the ring is full
+ * are dropped and counted rather than blocking the writer.
+ *
+ * Use through OBSERVER_TRACE, which compiles away when OBSERVER_TRACE_ENABLED
+ * is 0 (the default under NDEBUG).
+ */
+class TraceLog
+{
+private:
+    MpscRing<TraceRecord> records;
+    std::atomic<size_t> drops{0};
+
+    std::atomic<TraceSink *> sink{nullptr};
+    std::mutex drain_lock;
+    std::vector<TraceRecord> scratch;
+
+    std::thread flusher;
+    std::mutex wake_lock;
+    std::condition_variable wake;
+    bool stopping = false;
+    milliseconds interval;
+
+    // Caller holds drain_lock
+    void drain_into(TraceSink *target)
+    {
+        this->scratch.clear();
+        TraceRecord record;
+        while (this->records.pop(record))
+        {
+            this->scratch.push_back(record);
+        }
+
+        if (target && !this->scratch.empty())
+        {
+            target->write(this->scratch.data(), this->scratch.size());
+        }
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(this->wake_lock);
+        while (!this->stopping)
+        {
+            if (this->sink.load(std::memory_order_acquire))
+            {
+                this->wake.wait_for(lock, this->interval);
+            }
+            else
+            {
+                // Nothing can be recorded without a sink, sleep until one is installed
+                this->wake.wait(lock);
+            }
+            lock.unlock();
+            this->flush();
+            lock.lock();
+        }
+    }
+
+public:
+    /**
+     * @param capacity Records buffered between flushes, rounded up to a power of two
+     * @param interval Time between background flushes
+     */
+    explicit TraceLog(size_t capacity = 4096, milliseconds interval = milliseconds(50))
+        : records(capacity), interval(interval)
+    {
+    }
+
+    TraceLog(const TraceLog &) = delete;
+    TraceLog &operator=(const TraceLog &) = delete;
+
+    ~TraceLog()
+    {
+        if (this->flusher.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->wake_lock);
+                this->stopping = true;
+            }
+            this->wake.notify_one();
+            this->flusher.join();
+        }
+        this->flush();
+    }
+
+    /**
+     * @return TraceLog& Process-wide log used by OBSERVER_TRACE
+     */
+    static TraceLog &global()
+    {
+        static TraceLog log;
+        return log;
+    }
+
+    /**
+     * @brief Installs the sink, flushing anything pending into the previous one first
+     *
+     * Pass nullptr before destroying the installed sink. The flusher thread is
+     * started by the first install and sleeps without waking while no sink is
+     * installed.
+     *
+     * @param target Sink to write to, or nullptr to stop recording
+     */
+    void set_sink(TraceSink *target)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->drain_lock);
+            this->drain_into(this->sink.load(std::memory_order_relaxed));
+            this->sink.store(target, std::memory_order_release);
+        }
+
+        if (target && !this->flusher.joinable())
+        {
+            this->flusher = std::thread(&TraceLog::run, this);
+        }
+        else if (target)
+        {
+            // Taking the lock orders the store before the flusher's check, so the wakeup is never lost
+            {
+                std::lock_guard<std::mutex> lock(this->wake_lock);
+            }
+            this->wake.notify_one();
+        }
+    }
+
+    /**
+     * @brief Buffers a record for the next flush, callable from any thread
+     *
+     * @param label String literal naming the value
+     * @param old_value
+     * @param new_value
+     */
+    void record(const char *label, double old_value, double new_value)
+    {
+        if (!this->sink.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        if (!this->records.push(TraceRecord{label, old_value, new_value, AnimationStats::clock_us()}))
+        {
+            this->drops.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Writes every buffered record to the sink now, on the calling thread
+     */
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(this->drain_lock);
+        this->drain_into(this->sink.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @return size_t Records dropped because the buffer was full
+     */
+    size_t dropped() const
+    {
+        return this->drops.load(std::memory_order_relaxed);
+    }
+};
+
+#if OBSERVER_TRACE_ENABLED
+#define OBSERVER_TRACE(label, old_value, new_value) TraceLog::global().record(label, old_value, new_value)
+#else
+// Unevaluated, so arguments cost nothing but still count as used
+#define OBSERVER_TRACE(label, old_value, new_value) ((void)sizeof((label), (old_value), (new_value)))
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "geometry.h"
+#include "trace.h"
+
+class View
+{
+public:
+    // Bits in View::dirty, one per property
+    enum DirtyBits : uint32_t
+    {
+        DIRTY_X = 1 << 0,
+        DIRTY_Y = 1 << 1,
+        DIRTY_WIDTH = 1 << 2,
+        DIRTY_HEIGHT = 1 << 3,
+        DIRTY_R = 1 << 4,
+        DIRTY_G = 1 << 5,
+        DIRTY_B = 1 << 6,
+
+        DIRTY_FRAME = DIRTY_X | DIRTY_Y | DIRTY_WIDTH | DIRTY_HEIGHT,
+        DIRTY_COLOR = DIRTY_R | DIRTY_G | DIRTY_B
+    };
+
+    Color color;
+    Rect frame;
+
+    // Set by every property write, cleared by the renderer once it has pulled the view
+    uint32_t dirty = 0;
+
+    View(const View &) = delete;
+    View &operator=(const View &) = delete;
+
+    /**
+     * @return true Some property has been written since the last take_dirty()
+     */
+    bool is_dirty() const
+    {
+        return this->dirty != 0;
+    }
+
+    /**
+     * @brief Returns and clears the dirty bits, called once per frame by the renderer
+     *
+     * @return uint32_t DirtyBits of the properties written since the last call
+     */
+    uint32_t take_dirty()
+    {
+        uint32_t bits = this->dirty;
+        this->dirty = 0;
+        return bits;
+    }
+
+    View()
+    {
+        this->frame.position.x.track(&this->dirty, DIRTY_X);
+        this->frame.position.y.track(&this->dirty, DIRTY_Y);
+        this->frame.size.width.track(&this->dirty, DIRTY_WIDTH);
+        this->frame.size.height.track(&this->dirty, DIRTY_HEIGHT);
+        this->color.r.track(&this->dirty, DIRTY_R);
+        this->color.g.track(&this->dirty, DIRTY_G);
+        this->color.b.track(&this->dirty, DIRTY_B);
+
+#if OBSERVER_TRACE_ENABLED
+        this->frame.size.width.add_observer([](float old, float current) { OBSERVER_TRACE("width", old, current); });
+        this->frame.size.height.add_observer([](float old, float current) { OBSERVER_TRACE("height", old, current); });
+#endif
+    }
+};
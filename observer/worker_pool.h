@@ -0,0 +1,158 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * @brief Worker threads that evaluate chunked animation work with work stealing
+ *
+ * run() splits the chunks into one contiguous range per participant, the
+ * calling thread included. Each participant drains its own range and then
+ * steals the remaining chunks of the others, so uneven chunks still finish
+ * together. Jobs only compute into scratch buffers; anything touching
+ * ObservableProperty is left to the caller after run() returns.
+ */
+class AnimationWorkerPool
+{
+private:
+    struct Range
+    {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::unique_ptr<Range[]> ranges;
+    size_t participants;
+
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    uint64_t generation = 0;
+    size_t running = 0;
+    bool stopping = false;
+
+    void (*job)(void *, size_t) = nullptr;
+    void *context = nullptr;
+
+    void drain(size_t self)
+    {
+        // Own range first, then steal from the others in turn
+        for (size_t k = 0; k < this->participants; k++)
+        {
+            Range &range = this->ranges[(self + k) % this->participants];
+            for (;;)
+            {
+                size_t chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= range.end)
+                {
+                    break;
+                }
+                this->job(this->context, chunk);
+            }
+        }
+    }
+
+    void worker(size_t self)
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(this->mutex);
+        for (;;)
+        {
+            this->start_cv.wait(lock, [&]
+                                { return this->stopping || this->generation != seen; });
+            if (this->stopping)
+            {
+                return;
+            }
+            seen = this->generation;
+
+            lock.unlock();
+            this->drain(self);
+            lock.lock();
+
+            if (--this->running == 0)
+            {
+                this->done_cv.notify_one();
+            }
+        }
+    }
+
+public:
+    /**
+     * @param thread_count Worker threads to start besides the calling thread
+     */
+    explicit AnimationWorkerPool(size_t thread_count = std::max(1u, std::thread::hardware_concurrency()) - 1)
+        : ranges(new Range[thread_count + 1]), participants(thread_count + 1)
+    {
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            this->threads.emplace_back(&AnimationWorkerPool::worker, this, i);
+        }
+    }
+
+    AnimationWorkerPool(const AnimationWorkerPool &) = delete;
+    AnimationWorkerPool &operator=(const AnimationWorkerPool &) = delete;
+
+    ~AnimationWorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->start_cv.notify_all();
+        for (auto &thread : this->threads)
+        {
+            thread.join();
+        }
+    }
+
+    /**
+     * @return size_t Threads that take part in run(), the caller included
+     */
+    size_t concurrency() const
+    {
+        return this->participants;
+    }
+
+    /**
+     * @brief Calls job(context, i) for every chunk i in [0, chunks) and waits for all of them
+     *
+     * @param chunks Number of chunks
+     * @param job Evaluates one chunk, called concurrently from several threads
+     * @param context Passed through to job
+     */
+    void run(size_t chunks, void (*job)(void *, size_t), void *context)
+    {
+        if (this->threads.empty() || chunks <= 1)
+        {
+            for (size_t i = 0; i < chunks; i++)
+            {
+                job(context, i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->job = job;
+            this->context = context;
+
+            for (size_t p = 0; p < this->participants; p++)
+            {
+                this->ranges[p].next.store(chunks * p / this->participants, std::memory_order_relaxed);
+                this->ranges[p].end = chunks * (p + 1) / this->participants;
+            }
+
+            this->running = this->threads.size();
+            this->generation++;
+        }
+        this->start_cv.notify_all();
+
+        // The calling thread takes the last range
+        this->drain(this->participants - 1);
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->done_cv.wait(lock, [&]
+                           { return this->running == 0; });
+    }
+};
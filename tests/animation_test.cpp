@@ -0,0 +1,678 @@
+#include "check.h"
+
+#include "observable.h"
+
+static const int64_t START_US = 1000000;
+
+TEST(FloatAnimationStore, WritesInterpolatedValuesAndRetires)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    FloatAnimationStore store;
+    store.animate_to(&property, 0.0f, 100.0f, 100, START_US);
+
+    store.tick(START_US + 50000);
+    EXPECT_NEAR(property.value, 50.0f, 1e-3f);
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(store.completed, 0u);
+
+    store.tick(START_US + 100000);
+    EXPECT_EQ(property.value, 100.0f);
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_EQ(store.completed, 1u);
+}
+
+TEST(FloatAnimationStore, RetargetKeepsOneLaneAndStartsFromCurrentValue)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    FloatAnimationStore store;
+    store.animate_to(&property, 0.0f, 100.0f, 100, START_US);
+    store.tick(START_US + 50000);
+
+    store.animate_to(&property, 0.0f, 0.0f, 100, START_US + 50000);
+    EXPECT_EQ(store.size(), 1u);
+
+    // Continues upwards briefly with the old velocity before turning around
+    store.tick(START_US + 51000);
+    EXPECT_GT(property.value, 50.0f);
+
+    store.tick(START_US + 150000);
+    EXPECT_EQ(property.value, 0.0f);
+    EXPECT_EQ(store.size(), 0u);
+}
+
+TEST(FloatAnimationStore, RetiresLanesSwappedIntoPlace)
+{
+    std::vector<ObservableProperty<float> > properties(3);
+    FloatAnimationStore store;
+    store.animate_to(&properties[0], 0.0f, 1.0f, 10, START_US);
+    store.animate_to(&properties[1], 0.0f, 2.0f, 100, START_US);
+    store.animate_to(&properties[2], 0.0f, 3.0f, 10, START_US);
+
+    store.tick(START_US + 10000);
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(store.completed, 2u);
+    EXPECT_EQ(properties[0].value, 1.0f);
+    EXPECT_EQ(properties[2].value, 3.0f);
+
+    store.tick(START_US + 100000);
+    EXPECT_EQ(properties[1].value, 2.0f);
+}
+
+TEST(PhysicsAnimationStore, SpringSettlesOnTargetIndependentOfFrameRate)
+{
+    const int64_t frame_periods[] = {16667, 6944};
+    float halfway[2];
+    for (int run = 0; run < 2; run++)
+    {
+        ObservableProperty<float> property;
+        property.value = 0.0f;
+        PhysicsAnimationStore store;
+        store.spring(&property, 0.0f, 0.0f, 100.0f, SpringConfig(), 0);
+
+        int64_t now = 0;
+        while (now < 200000)
+        {
+            now += frame_periods[run];
+            store.tick(now);
+        }
+        // Sample both runs at the same instant
+        store.tick(200000 + PhysicsAnimationStore::STEP_US * 10);
+        halfway[run] = property.value;
+
+        now = 200000 + PhysicsAnimationStore::STEP_US * 10;
+        while (store.size() > 0 && now < 5000000)
+        {
+            now += frame_periods[run];
+            store.tick(now);
+        }
+        EXPECT_EQ(store.size(), 0u);
+        EXPECT_EQ(property.value, 100.0f);
+    }
+    EXPECT_NEAR(halfway[0], halfway[1], 0.5f);
+}
+
+TEST(PhysicsAnimationStore, TakeHandsOffTheLastRenderedValue)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    PhysicsAnimationStore store;
+    store.spring(&property, 0.0f, 0.0f, 100.0f, SpringConfig(), 0);
+
+    // Part way between two fixed steps, so the rendered value is interpolated
+    store.tick(PhysicsAnimationStore::STEP_US * 5 + PhysicsAnimationStore::STEP_US / 2);
+    float rendered = property.value;
+
+    float value = 0.0f;
+    float speed = 0.0f;
+    EXPECT_TRUE(store.take(&property, value, speed));
+    EXPECT_EQ(value, rendered);
+    EXPECT_GT(speed, 0.0f);
+    EXPECT_EQ(store.size(), 0u);
+}
+
+TEST(PhysicsAnimationStore, DecayCoastsToFrictionLimit)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    PhysicsAnimationStore store;
+    store.decay(&property, 0.0f, 1000.0f, DecayConfig(), 0);
+
+    int64_t now = 0;
+    while (store.size() > 0 && now < 20000000)
+    {
+        now += 16667;
+        store.tick(now);
+    }
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_NEAR(property.value, 500.0f, 10.0f);
+}
+
+TEST(FloatAnimationStore, IdleTickClearsCompletedCount)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    FloatAnimationStore store;
+    store.animate_to(&property, 0.0f, 1.0f, 10, START_US);
+
+    store.tick(START_US + 10000);
+    EXPECT_EQ(store.completed, 1u);
+    store.tick(START_US + 20000);
+    EXPECT_EQ(store.completed, 0u);
+}
+
+TEST(AnimationPool, ReusesReleasedSlotsWithoutMovingLiveAnimations)
+{
+    AnimationPool<Animation<int>, 4> pool;
+    std::vector<AnimationHandle> handles;
+    for (int i = 0; i < 6; i++)
+    {
+        Animation<int> animation;
+        animation.property = nullptr;
+        animation.start = 0;
+        animation.end = i;
+        animation.duration = 100;
+        animation.prep(START_US);
+        handles.push_back(pool.acquire(animation));
+    }
+    Animation<int> *stable = pool.get(handles[5]);
+    EXPECT_EQ(pool.size(), 6u);
+
+    EXPECT_TRUE(pool.release(handles[1]));
+    EXPECT_FALSE(pool.release(handles[1]));
+    EXPECT_EQ(pool.get(handles[1]), nullptr);
+
+    // The freed slot is reused, the stale handle stays dead and nothing moved
+    Animation<int> replacement;
+    replacement.property = nullptr;
+    replacement.start = 0;
+    replacement.end = 42;
+    replacement.duration = 100;
+    replacement.prep(START_US);
+    AnimationHandle reused = pool.acquire(replacement);
+    EXPECT_EQ(reused.index, handles[1].index);
+    EXPECT_NE(reused.generation, handles[1].generation);
+    EXPECT_EQ(pool.get(handles[1]), nullptr);
+    EXPECT_EQ(pool.get(reused)->end, 42);
+    EXPECT_EQ(pool.get(handles[5]), stable);
+    EXPECT_EQ(stable->end, 5);
+    EXPECT_EQ(pool.size(), 6u);
+}
+
+TEST(KeyframeTrack, SamplesSegmentsAndClampsEnds)
+{
+    KeyframeTrack<float> track;
+    track.add(0.0f, 0.0f);
+    track.add(100.0f, 10.0f);
+    track.add(200.0f, 0.0f);
+
+    size_t segment = 0;
+    EXPECT_EQ(track.sample(-5.0f, segment), 0.0f);
+    EXPECT_NEAR(track.sample(50.0f, segment), 5.0f, 1e-4f);
+    EXPECT_NEAR(track.sample(150.0f, segment), 5.0f, 1e-4f);
+    EXPECT_EQ(segment, 1u);
+    EXPECT_EQ(track.sample(500.0f, segment), 0.0f);
+}
+
+TEST(KeyframeTrack, EmptyTrackSamplesDefaultAndCompletes)
+{
+    KeyframeTrack<float> track;
+    size_t segment = 3;
+    EXPECT_EQ(track.sample(10.0f, segment), 0.0f);
+    EXPECT_EQ(segment, 0u);
+
+    ObservableProperty<float> property;
+
+    property.value = 7.0f;
+    KeyframeAnimation<float> animation;
+    animation.property = &property;
+    animation.track = &track;
+    animation.prep(START_US);
+    EXPECT_TRUE(animation.advance(START_US + 1000).completed);
+    EXPECT_EQ(property.value, 7.0f);
+}
+
+TEST(AnimationGroup, PausedGroupWritesOnceThenIdles)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationGroup<> group;
+    group.duration = 100;
+    Animation<float> member;
+    member.property = &property;
+    member.start = 0.0f;
+    member.end = 100.0f;
+    group.add(member);
+    group.prep(START_US);
+
+    group.pause(START_US + 50000);
+    AnimationStep<float> step = group.advance(START_US + 60000);
+    EXPECT_FALSE(step.idle);
+    EXPECT_NEAR(property.value, 50.0f, 1e-3f);
+    uint32_t version = property.version;
+
+    step = group.advance(START_US + 70000);
+    EXPECT_TRUE(step.idle);
+    EXPECT_FALSE(step.completed);
+    EXPECT_EQ(property.version, version);
+
+    group.seek(START_US + 70000, 25.0f);
+    EXPECT_FALSE(group.advance(START_US + 80000).idle);
+    EXPECT_NEAR(property.value, 25.0f, 1e-3f);
+
+    group.resume(START_US + 80000);
+    EXPECT_TRUE(group.advance(START_US + 155000).completed);
+    EXPECT_EQ(property.value, 100.0f);
+}
+
+TEST(AnimationScheduler, CancelsFloatLanesByProperty)
+{
+    ObservableProperty<float> timed;
+    timed.value = 0.0f;
+    ObservableProperty<float> sprung;
+    sprung.value = 0.0f;
+    AnimationScheduler scheduler;
+
+    Animation<float> animation;
+    animation.property = &timed;
+    animation.start = 0.0f;
+    animation.end = 1.0f;
+    animation.duration = 1000;
+    scheduler.add(animation);
+    scheduler.spring_to(&sprung, 10.0f);
+
+    EXPECT_TRUE(scheduler.animating(&timed));
+    EXPECT_TRUE(scheduler.animating(&sprung));
+    EXPECT_TRUE(scheduler.cancel(&timed));
+    EXPECT_TRUE(scheduler.cancel(&sprung));
+    EXPECT_FALSE(scheduler.cancel(&timed));
+    EXPECT_FALSE(scheduler.animating(&sprung));
+    EXPECT_EQ(scheduler.active(), 0u);
+}
+
+TEST(AnimationScheduler, PooledAnimationsReplaceTheOneOnTheirProperty)
+{
+    ObservableProperty<int> counter;
+    counter.value = 0;
+    ObservableProperty<float> eased;
+    eased.value = 0.0f;
+    AnimationScheduler scheduler;
+
+    Animation<int> first;
+    first.property = &counter;
+    first.start = 0;
+    first.end = 100;
+    first.duration = 1000;
+    Animation<int> second = first;
+    second.end = -100;
+
+    Animation<float, EaseOut> curve;
+    curve.property = &eased;
+    curve.start = 0.0f;
+    curve.end = 1.0f;
+    curve.duration = 1000;
+
+    AnimationCore::begin_frame(START_US);
+    AnimationHandle replaced = scheduler.add(first);
+    AnimationHandle current = scheduler.add(second);
+    AnimationHandle curved = scheduler.add(curve);
+    AnimationCore::end_frame();
+
+    EXPECT_EQ(scheduler.find<int>(replaced), nullptr);
+    EXPECT_NE(scheduler.find<int>(current), nullptr);
+    EXPECT_EQ(scheduler.active(), 2u);
+
+    // A linear float animation, spring or cancel takes over from the pooled one
+    scheduler.spring_to(&eased, 2.0f);
+    EXPECT_EQ((scheduler.find<float, EaseOut>(curved)), nullptr);
+    EXPECT_TRUE(scheduler.cancel(&eased));
+    EXPECT_EQ(scheduler.active(), 1u);
+
+    scheduler.tick(START_US + 500000);
+    EXPECT_EQ(counter.value, -50);
+}
+
+TEST(AnimationScheduler, AnimationsStartedInAFrameShareItsTimestamp)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    AnimationScheduler scheduler;
+    Animation<int> animation;
+    animation.property = &property;
+    animation.start = 0;
+    animation.end = 10;
+    animation.duration = 100;
+
+    AnimationCore::begin_frame(START_US);
+    EXPECT_EQ(AnimationCore::start_time(), START_US);
+    AnimationHandle handle = scheduler.add(animation);
+    AnimationCore::end_frame();
+    EXPECT_EQ(scheduler.find<int>(handle)->get_start_time(), START_US);
+
+    scheduler.tick(START_US + 50000);
+    EXPECT_EQ(property.value, 5);
+
+    scheduler.tick(START_US + 100000);
+    EXPECT_EQ(property.value, 10);
+    EXPECT_EQ(scheduler.active(), 0u);
+    EXPECT_EQ(scheduler.completed_this_frame(), 1u);
+    EXPECT_EQ(scheduler.find<int>(handle), nullptr);
+}
+
+TEST(AnimationScheduler, StartTimeBetweenFramesNeverPrecedesLastFrame)
+{
+    int64_t ahead = AnimationCore::now_us() + 5000000;
+    AnimationCore::begin_frame(ahead);
+    AnimationCore::end_frame();
+    EXPECT_EQ(AnimationCore::start_time(), ahead);
+
+    // A spring started between frames must not run backwards on the next one
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationScheduler scheduler;
+    scheduler.spring_to(&property, 100.0f);
+    scheduler.tick(ahead + 8333);
+    EXPECT_GT(property.value, 0.0f);
+    EXPECT_LT(property.value, 100.0f);
+
+    AnimationCore::begin_frame(AnimationCore::now_us());
+    AnimationCore::end_frame();
+}
+
+TEST(FloatAnimationStore, KeepsSubMillisecondResolutionWhileNeverDraining)
+{
+    const int64_t DAY_US = 86400ll * 1000000;
+    ObservableProperty<float> background;
+    background.value = 0.0f;
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    FloatAnimationStore store;
+    store.animate_to(&background, 0.0f, 1.0f, DAY_US / 1000 * 2, START_US);
+
+    int64_t now = START_US;
+    while (now < START_US + DAY_US)
+    {
+        now += 10000000;
+        store.tick(now);
+    }
+
+    // 1 ms frames over a 100 ms animation must advance evenly by about 0.01 each
+    store.animate_to(&property, 0.0f, 1.0f, 100, now);
+    float last = 0.0f;
+    for (int frame = 1; frame <= 10; frame++)
+    {
+        store.tick(now + frame * 1000);
+        EXPECT_NEAR(property.value - last, 0.01f, 0.001f);
+        last = property.value;
+    }
+}
+
+TEST(CompositeAnimation, ColorAnimatesAsPackedRGBA8)
+{
+    Color color;
+    color.r.value = 0;
+    color.g.value = 100;
+    color.b.value = 300;
+
+    CompositeAnimation<Color, Linear> animation;
+    animation.target = &color;
+    animation.start_from_current();
+    EXPECT_EQ(animation.start, RGBA8::make(0, 100, 255));
+    animation.end = RGBA8::make(200, 0, 255);
+    animation.duration = 100;
+    animation.prep(START_US);
+
+    AnimationStep<RGBA8> step = animation.advance(START_US + 50000);
+    EXPECT_EQ(step.value, lerp(RGBA8::make(0, 100, 255), RGBA8::make(200, 0, 255), 0.5f));
+    EXPECT_EQ(color.r.value, 100);
+    EXPECT_EQ(color.g.value, 50);
+    EXPECT_EQ(color.b.value, 255);
+
+    EXPECT_TRUE(animation.advance(START_US + 100000).completed);
+    EXPECT_EQ(color.r.value, 200);
+    EXPECT_EQ(color.g.value, 0);
+}
+
+// Used by no other test, so their batch ids come after the composite one's
+struct TrailingEasing
+{
+    static constexpr float apply(float t)
+    {
+        return t;
+    }
+};
+
+struct OnUpdateEasing
+{
+    static constexpr float apply(float t)
+    {
+        return t;
+    }
+};
+
+TEST(AnimationScheduler, CompositeOnUpdateCanStartANewAnimationType)
+{
+    Point point;
+    ObservableProperty<int> counter;
+    counter.value = 0;
+    ObservableProperty<int> trailing;
+    trailing.value = 0;
+    AnimationScheduler scheduler;
+    bool started = false;
+
+    CompositeAnimation<Point, Linear> animation;
+    animation.target = &point;
+    animation.start_from_current();
+    animation.end = AnimationVector{{100.0f, 0.0f, 0.0f, 0.0f}};
+    animation.duration = 100;
+    animation.on_update = [&scheduler, &counter, &started](Point &) {
+        if (started)
+        {
+            return;
+        }
+        started = true;
+        Animation<int, OnUpdateEasing> count;
+        count.property = &counter;
+        count.start = 0;
+        count.end = 10;
+        count.duration = 100;
+        scheduler.add(count);
+    };
+
+    Animation<int, TrailingEasing> after;
+    after.property = &trailing;
+    after.start = 0;
+    after.end = 10;
+    after.duration = 100;
+
+    // Fix the composite batch's id first, then size the batch list exactly to
+    // the trailing batch so the one created from on_update must grow it
+    AnimationScheduler().find_composite<Point>(AnimationHandle());
+    AnimationCore::begin_frame(START_US);
+    scheduler.add(after);
+    scheduler.add(animation);
+    AnimationCore::end_frame();
+
+    AnimationCore::begin_frame(START_US + 50000);
+    scheduler.tick(START_US + 50000);
+    AnimationCore::end_frame();
+    EXPECT_TRUE(started);
+    EXPECT_EQ(trailing.value, 5);
+    EXPECT_EQ(scheduler.active(), 3u);
+
+    scheduler.tick(START_US + 150000);
+    EXPECT_EQ(point.x.value, 100.0f);
+    EXPECT_EQ(counter.value, 10);
+    EXPECT_EQ(scheduler.active(), 0u);
+}
+
+TEST(AnimationScheduler, CompositeColorClampsChannelsThatPerChannelAnimationKeeps)
+{
+    Color packed;
+    packed.r.value = -40;
+    packed.g.value = 0;
+    packed.b.value = 400;
+    Color split;
+    split.r.value = -40;
+    split.g.value = 0;
+    split.b.value = 400;
+    AnimationScheduler scheduler;
+
+    CompositeAnimation<Color, Linear> composite;
+    composite.target = &packed;
+    composite.start_from_current();
+    composite.end = RGBA8::make(0, 200, 255);
+    composite.duration = 100;
+
+    Animation<int> red;
+    red.property = &split.r;
+    red.start = -40;
+    red.end = 0;
+    red.duration = 100;
+    Animation<int> blue = red;
+    blue.property = &split.b;
+    blue.start = 400;
+    blue.end = 255;
+
+    AnimationCore::begin_frame(START_US);
+    scheduler.add(composite);
+    scheduler.add(red);
+    scheduler.add(blue);
+    AnimationCore::end_frame();
+
+    // The composite starts from the clamped channels, the int animations from the stored ones
+    scheduler.tick(START_US);
+    EXPECT_EQ(packed.r.value, 0);
+    EXPECT_EQ(packed.b.value, 255);
+    EXPECT_EQ(split.r.value, -40);
+    EXPECT_EQ(split.b.value, 400);
+
+    scheduler.tick(START_US + 100000);
+    EXPECT_EQ(packed.g.value, 200);
+    EXPECT_EQ(split.r.value, 0);
+    EXPECT_EQ(split.b.value, 255);
+}
+
+TEST(CompositeAnimation, RectLerpsFourLanes)
+{
+    Rect rect;
+    rect.position.x.value = 0.0f;
+    rect.position.y.value = 0.0f;
+    rect.size.width.value = 10.0f;
+    rect.size.height.value = 10.0f;
+
+    CompositeAnimation<Rect, Linear> animation;
+    animation.target = &rect;
+    animation.start_from_current();
+    animation.end = AnimationVector{{100.0f, 50.0f, 20.0f, 30.0f}};
+    animation.duration = 100;
+    animation.prep(START_US);
+
+    animation.advance(START_US + 50000);
+    EXPECT_NEAR(rect.position.x.value, 50.0f, 1e-4f);
+    EXPECT_NEAR(rect.size.height.value, 20.0f, 1e-4f);
+}
+
+TEST(AnimationScheduler, CompositeOnUpdateCanRetargetItsOwnAnimation)
+{
+    Point point;
+    point.x.value = 0.0f;
+    point.y.value = 0.0f;
+    AnimationScheduler scheduler;
+    int updates = 0;
+
+    CompositeAnimation<Point, Linear> animation;
+    animation.target = &point;
+    animation.start_from_current();
+    animation.end = AnimationVector{{100.0f, 0.0f, 0.0f, 0.0f}};
+    animation.duration = 100;
+    animation.on_update = [&scheduler, &updates](Point &target) {
+        if (updates++ > 0)
+        {
+            return;
+        }
+        // Replaces, and so releases, the animation running this callback
+        CompositeAnimation<Point, Linear> reverse;
+        reverse.target = &target;
+        reverse.start_from_current();
+        reverse.end = AnimationVector{{-100.0f, 0.0f, 0.0f, 0.0f}};
+        reverse.duration = 100;
+        scheduler.add(reverse);
+    };
+
+    AnimationCore::begin_frame(START_US);
+    AnimationHandle first = scheduler.add(animation);
+    AnimationCore::end_frame();
+
+    AnimationCore::begin_frame(START_US + 50000);
+    scheduler.tick(START_US + 50000);
+    AnimationCore::end_frame();
+    EXPECT_NEAR(point.x.value, 50.0f, 1e-4f);
+    EXPECT_EQ((scheduler.find_composite<Point>(first)), nullptr);
+    EXPECT_EQ(scheduler.active(), 1u);
+    EXPECT_EQ(scheduler.completed_this_frame(), 0u);
+
+    AnimationCore::begin_frame(START_US + 150000);
+    scheduler.tick(START_US + 150000);
+    AnimationCore::end_frame();
+    EXPECT_EQ(point.x.value, -100.0f);
+    EXPECT_EQ(updates, 1);
+    EXPECT_EQ(scheduler.active(), 0u);
+    EXPECT_EQ(scheduler.completed_this_frame(), 1u);
+}
+
+TEST(AnimationScheduler, ComputedObserversRunAfterTheFrameCommits)
+{
+    ObservableProperty<float> driven;
+    driven.value = 0.0f;
+    ObservableProperty<float> cancelled;
+    cancelled.value = 0.0f;
+    ObservableProperty<float> finishing;
+    finishing.value = 0.0f;
+    ObservableProperty<int> counter;
+    counter.value = 0;
+    AnimationScheduler scheduler;
+
+    AnimationCore::begin_frame(START_US);
+    scheduler.animate_to(&driven, 10.0f, 100);
+    scheduler.animate_to(&cancelled, 10.0f, 100);
+    scheduler.animate_to(&finishing, 10.0f, 50);
+    AnimationCore::end_frame();
+
+    ComputedProperty<float> doubled([&] { return driven.value * 2.0f; }, driven);
+    int calls = 0;
+    float seen_cancelled = -1.0f;
+    doubled.add_observer([&](float, float)
+                         {
+                             if (calls++ == 0)
+                             {
+                                 // Lanes written this frame are all stored by now
+                                 seen_cancelled = cancelled.value;
+                                 scheduler.cancel(&cancelled);
+
+                                 // A batch type no scheduler has created yet
+                                 Animation<int, Steps<3> > steps;
+                                 steps.property = &counter;
+                                 steps.start = 0;
+                                 steps.end = 3;
+                                 steps.duration = 100;
+                                 scheduler.add(steps);
+                             }
+                         });
+
+    scheduler.tick(START_US + 50000);
+    EXPECT_EQ(calls, 1);
+    EXPECT_NEAR(seen_cancelled, 5.0f, 1e-3f);
+    EXPECT_FALSE(scheduler.animating(&cancelled));
+    EXPECT_FALSE(scheduler.animating(&finishing));
+    EXPECT_EQ(finishing.value, 10.0f);
+    EXPECT_TRUE(scheduler.animating(&driven));
+    EXPECT_EQ(scheduler.active(), 2u);
+
+    scheduler.tick(START_US + 100000);
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(driven.value, 10.0f);
+    EXPECT_NEAR(cancelled.value, 5.0f, 1e-3f);
+}
+
+TEST(AnimationScheduler, ImportReplacesSpringOnTheProperty)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationScheduler scheduler;
+
+    AnimationCore::begin_frame(START_US);
+    scheduler.spring_to(&property, 100.0f);
+    AnimationCore::end_frame();
+
+    // Half way through a 0 -> 10 animation lasting 100 ms
+    scheduler.import_float_animation(FloatLaneState{&property, 0.0f, 10.0f, 0.0f, 50.0f, 0.01f}, START_US);
+    EXPECT_EQ(scheduler.active(), 1u);
+
+    scheduler.tick(START_US + 25000);
+    EXPECT_NEAR(property.value, 7.5f, 1e-3f);
+    scheduler.tick(START_US + 50000);
+    EXPECT_EQ(property.value, 10.0f);
+    EXPECT_FALSE(scheduler.animating(&property));
+}
@@ -0,0 +1,149 @@
+#include "check.h"
+
+#include "observable.h"
+
+struct Quad
+{
+    float a;
+    float b;
+    float c;
+    float d;
+};
+
+TEST(AtomicProperty, ConcurrentWritersNotifyOncePerWrite)
+{
+    static const int WRITERS = 4;
+    static const int WRITES = 2000;
+    AtomicProperty<int> property(0);
+    std::atomic<int> calls{0};
+    property.add_observer([&calls](int, int) { calls.fetch_add(1, std::memory_order_relaxed); });
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < WRITERS; w++)
+    {
+        writers.emplace_back([&property, w]
+                             {
+                                 for (int i = 1; i <= WRITES; i++)
+                                 {
+                                     property = w * WRITES + i;
+                                 }
+                             });
+    }
+    for (auto &writer : writers)
+    {
+        writer.join();
+    }
+
+    EXPECT_EQ(calls.load(), WRITERS * WRITES);
+    EXPECT_EQ(property.load() % WRITES, 0);
+}
+
+TEST(AtomicProperty, SeqLockReadsAreNeverTorn)
+{
+    AtomicProperty<Quad> property(Quad{0.0f, 0.0f, 0.0f, 0.0f});
+    std::atomic<bool> done{false};
+
+    std::thread writer([&]
+                       {
+                           for (int i = 1; i <= 20000; i++)
+                           {
+                               float v = (float)i;
+                               property = Quad{v, v, v, v};
+                           }
+                           done.store(true);
+                       });
+
+    bool consistent = true;
+    while (!done.load())
+    {
+        Quad seen = property.load();
+        consistent = consistent && seen.a == seen.b && seen.b == seen.c && seen.c == seen.d;
+    }
+    writer.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(property.load().d, 20000.0f);
+}
+
+TEST(AtomicProperty, ObserverAddedAndRemovedWhileWriting)
+{
+    AtomicProperty<float> property(0.0f);
+    std::atomic<bool> done{false};
+    std::thread writer([&]
+                       {
+                           for (int i = 0; i < 20000; i++)
+                           {
+                               property = (float)i;
+                           }
+                           done.store(true);
+                       });
+
+    std::atomic<int> calls{0};
+    while (!done.load())
+    {
+        ObserverHandle handle = property.add_observer([&calls](float, float) { calls++; });
+        EXPECT_TRUE(property.remove_observer(handle));
+    }
+    writer.join();
+
+    // After the last remove, no observer is left to call
+    int settled = calls.load();
+    property = -1.0f;
+    EXPECT_EQ(calls.load(), settled);
+}
+
+TEST(AtomicProperty, QueuedWritesCoalesceIntoOneDelivery)
+{
+    DispatchQueue queue(16);
+    AtomicProperty<int> property(1);
+    property.set_dispatch_queue(&queue);
+
+    std::vector<std::pair<int, int> > seen;
+    property.add_observer([&seen](int old, int current) { seen.emplace_back(old, current); });
+
+    std::thread writer([&property]
+                       {
+                           for (int i = 2; i <= 100; i++)
+                           {
+                               property = i;
+                           }
+                       });
+    writer.join();
+    EXPECT_TRUE(seen.empty());
+
+    // Observers run on the draining thread, once, from the last delivered value
+    EXPECT_EQ(queue.drain(), 1u);
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0].first, 1);
+    EXPECT_EQ(seen[0].second, 100);
+
+    property = 7;
+    queue.drain();
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[1].first, 100);
+    EXPECT_EQ(seen[1].second, 7);
+}
+
+TEST(AtomicProperty, DestroyedPropertyWithdrawsItsQueuedNotification)
+{
+    DispatchQueue queue(16);
+    int notified = 0;
+    {
+        AtomicProperty<int> doomed(1);
+        doomed.set_dispatch_queue(&queue);
+        doomed.add_observer([&notified](int, int) { notified++; });
+        doomed = 2;
+    }
+
+    // A property reusing the address still gets its own notification
+    AtomicProperty<int> survivor(1);
+    survivor.set_dispatch_queue(&queue);
+    std::vector<int> seen;
+    survivor.add_observer([&seen](int, int current) { seen.push_back(current); });
+    survivor = 3;
+
+    EXPECT_EQ(queue.drain(), 1u);
+    EXPECT_EQ(notified, 0);
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0], 3);
+}
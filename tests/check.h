@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Minimal test registry, so the tests build without any dependency
+ *
+ * Tests are declared with TEST(Suite, Name) and registered before main runs.
+ * A failed check prints its location and marks the test failed; ASSERT_*
+ * checks also return from the test.
+ */
+class TestRegistry
+{
+public:
+    struct Case
+    {
+        const char *suite;
+        const char *name;
+        void (*run)();
+    };
+
+    static std::vector<Case> &cases()
+    {
+        static std::vector<Case> value;
+        return value;
+    }
+
+    static int &failures()
+    {
+        static int value = 0;
+        return value;
+    }
+
+    static bool add(const char *suite, const char *name, void (*run)())
+    {
+        cases().push_back(Case{suite, name, run});
+        return true;
+    }
+
+    static bool check(bool passed, const char *expression, const char *file, int line)
+    {
+        if (!passed)
+        {
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+            failures()++;
+        }
+        return passed;
+    }
+
+    /**
+     * @brief Runs every registered test, or only the suite named by filter
+     *
+     * @param filter Suite name, or nullptr for all
+     * @return int Process exit code, 0 if every check passed
+     */
+    static int run_all(const char *filter)
+    {
+        int failed_cases = 0;
+        for (const Case &test : cases())
+        {
+            if (filter && std::strcmp(filter, test.suite) != 0)
+            {
+                continue;
+            }
+
+            int before = failures();
+            test.run();
+            bool passed = failures() == before;
+            failed_cases += passed ? 0 : 1;
+            std::printf("[%s] %s.%s\n", passed ? "  OK  " : " FAIL ", test.suite, test.name);
+        }
+        std::printf("%d failed\n", failed_cases);
+        return failed_cases == 0 ? 0 : 1;
+    }
+};
+
+#define TEST(suite, name)                                                                      \
+    static void suite##_##name();                                                              \
+    static const bool suite##_##name##_registered = TestRegistry::add(#suite, #name, &suite##_##name); \
+    static void suite##_##name()
+
+#define EXPECT_TRUE(condition) TestRegistry::check((condition), #condition, __FILE__, __LINE__)
+#define EXPECT_FALSE(condition) TestRegistry::check(!(condition), "!(" #condition ")", __FILE__, __LINE__)
+#define EXPECT_EQ(a, b) TestRegistry::check((a) == (b), #a " == " #b, __FILE__, __LINE__)
+#define EXPECT_NE(a, b) TestRegistry::check((a) != (b), #a " != " #b, __FILE__, __LINE__)
+#define EXPECT_GT(a, b) TestRegistry::check((a) > (b), #a " > " #b, __FILE__, __LINE__)
+#define EXPECT_GE(a, b) TestRegistry::check((a) >= (b), #a " >= " #b, __FILE__, __LINE__)
+#define EXPECT_LT(a, b) TestRegistry::check((a) < (b), #a " < " #b, __FILE__, __LINE__)
+#define EXPECT_NEAR(a, b, tolerance) \
+    TestRegistry::check(std::fabs((a) - (b)) <= (tolerance), #a " near " #b, __FILE__, __LINE__)
+#define ASSERT_EQ(a, b)      \
+    if (!EXPECT_EQ(a, b))    \
+    {                        \
+        return;              \
+    }
@@ -0,0 +1,114 @@
+#include "check.h"
+
+#include "observable.h"
+
+TEST(ComputedProperty, RecomputesLazilyAfterInputChange)
+{
+    ObservableProperty<float> x;
+    x.value = 1.0f;
+    ObservableProperty<float> w;
+    w.value = 2.0f;
+    int computations = 0;
+    ComputedProperty<float> right(
+        [&]
+        {
+            computations++;
+            return x.value + w.value;
+        },
+        x, w);
+    computations = 0;
+
+    x = 10.0f;
+    EXPECT_TRUE(right.is_dirty());
+    EXPECT_EQ(computations, 0);
+    EXPECT_EQ(right.get(), 12.0f);
+    EXPECT_EQ(right.get(), 12.0f);
+    EXPECT_EQ(computations, 1);
+}
+
+TEST(ComputedProperty, BatchedInputsRecomputeOnce)
+{
+    ObservableProperty<float> x;
+    x.value = 1.0f;
+    ObservableProperty<float> w;
+    w.value = 2.0f;
+    ComputedProperty<float> right([&] { return x.value + w.value; }, x, w);
+    int calls = 0;
+    right.add_observer([&calls](float, float) { calls++; });
+
+    {
+        PropertyBatch batch;
+        x = 5.0f;
+        w = 5.0f;
+    }
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(right.get(), 10.0f);
+}
+
+TEST(ComputedProperty, DiamondNotifiesOnceWithConsistentValues)
+{
+    ObservableProperty<int> a;
+    a.value = 1;
+    ComputedProperty<int> left([&] { return a.value * 2; }, a);
+    ComputedProperty<int> right([&] { return a.value * 3; }, a);
+    ComputedProperty<int> sum([&] { return left.get() + right.get(); }, left, right);
+
+    std::vector<int> seen;
+    sum.add_observer([&seen](int, int current) { seen.push_back(current); });
+
+    a = 2;
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0], 10);
+}
+
+TEST(ComputedProperty, UnchangedResultDoesNotNotify)
+{
+    ObservableProperty<int> a;
+    a.value = 1;
+    ComputedProperty<bool> positive([&] { return a.value > 0; }, a);
+    int calls = 0;
+    positive.add_observer([&calls](bool, bool) { calls++; });
+
+    a = 2;
+    EXPECT_EQ(calls, 0);
+    a = -1;
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ComputedProperty, InputObserverReadingItNeverLeavesItStale)
+{
+    ObservableProperty<float> x;
+    x.value = 1.0f;
+    ObservableProperty<float> w;
+    w.value = 2.0f;
+    ComputedProperty<float> right([&] { return x.value + w.value; }, x, w);
+
+    // Immediate observers run before the write is stored, so they still see the old sum
+    float seen = 0.0f;
+    x.add_observer([&](float, float) { seen = right.get(); });
+
+    x = 10.0f;
+    EXPECT_EQ(seen, 3.0f);
+    EXPECT_EQ(right.get(), 12.0f);
+}
+
+TEST(ComputedProperty, ReadsInsideBatchSeeStoredWrites)
+{
+    ObservableProperty<float> x;
+    x.value = 1.0f;
+    ObservableProperty<float> w;
+    w.value = 2.0f;
+    ComputedProperty<float> right([&] { return x.value + w.value; }, x, w);
+    x.add_observer([](float, float) {});
+
+    {
+        PropertyBatch batch;
+        x = 10.0f;
+        EXPECT_EQ(right.get(), 12.0f);
+    }
+    EXPECT_EQ(right.get(), 12.0f);
+
+    // Animation writes bypass observers but still mark dependents
+    w.store(5.0f);
+    EXPECT_EQ(right.get(), 15.0f);
+}
@@ -0,0 +1,98 @@
+#include "check.h"
+
+#include "observable.h"
+
+TEST(MpscRing, RejectsPushesOnceFullAndKeepsOrder)
+{
+    MpscRing<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_FALSE(ring.push(4));
+
+    int item = -1;
+    EXPECT_TRUE(ring.pop(item));
+    EXPECT_EQ(item, 0);
+    EXPECT_TRUE(ring.push(4));
+    for (int expected = 1; expected <= 4; expected++)
+    {
+        EXPECT_TRUE(ring.pop(item));
+        EXPECT_EQ(item, expected);
+    }
+    EXPECT_FALSE(ring.pop(item));
+}
+
+TEST(MpscRing, ConcurrentProducersLoseNothing)
+{
+    static const int PRODUCERS = 4;
+    static const int PER_PRODUCER = 10000;
+    MpscRing<int> ring(PRODUCERS * PER_PRODUCER);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&ring, p]
+                               {
+                                   for (int i = 0; i < PER_PRODUCER; i++)
+                                   {
+                                       ring.push(p * PER_PRODUCER + i);
+                                   }
+                               });
+    }
+
+    std::vector<int> last(PRODUCERS, -1);
+    int received = 0;
+    bool ordered = true;
+    while (received < PRODUCERS * PER_PRODUCER)
+    {
+        int item;
+        if (ring.pop(item))
+        {
+            // Each producer's items arrive in the order it pushed them
+            int producer = item / PER_PRODUCER;
+            ordered = ordered && item > last[producer];
+            last[producer] = item;
+            received++;
+        }
+    }
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    EXPECT_TRUE(ordered);
+    int item;
+    EXPECT_FALSE(ring.pop(item));
+}
+
+struct Delivery
+{
+    int id;
+    std::vector<int> *log;
+};
+
+static void record_delivery(void *property)
+{
+    Delivery *delivery = static_cast<Delivery *>(property);
+    delivery->log->push_back(delivery->id);
+}
+
+TEST(DispatchQueue, CountsOverflowAndDrainsInOrder)
+{
+    DispatchQueue queue(2);
+    std::vector<int> log;
+    Delivery first{1, &log};
+    Delivery second{2, &log};
+
+    EXPECT_TRUE(queue.push(DispatchQueue::Notification{&first, &record_delivery}));
+    EXPECT_TRUE(queue.push(DispatchQueue::Notification{&second, &record_delivery}));
+    EXPECT_FALSE(queue.push(DispatchQueue::Notification{&first, &record_delivery}));
+    EXPECT_EQ(queue.overflowed(), 1u);
+
+    EXPECT_EQ(queue.drain(), 2u);
+    ASSERT_EQ(log.size(), 2u);
+    EXPECT_EQ(log[0], 1);
+    EXPECT_EQ(log[1], 2);
+}
@@ -0,0 +1,95 @@
+#include "check.h"
+
+#include "observable.h"
+
+TEST(CubicBezier, PresetsHitTheirEndpointsAndStayMonotonic)
+{
+    EXPECT_NEAR(EaseInOut::apply(0.0f), 0.0f, 1e-5f);
+    EXPECT_NEAR(EaseInOut::apply(1.0f), 1.0f, 1e-5f);
+    // Symmetric control points give a symmetric curve
+    EXPECT_NEAR(EaseInOut::apply(0.5f), 0.5f, 1e-4f);
+    EXPECT_NEAR(EaseInOut::apply(0.25f) + EaseInOut::apply(0.75f), 1.0f, 1e-4f);
+
+    EXPECT_LT(EaseIn::apply(0.5f), 0.5f);
+    EXPECT_GT(EaseOut::apply(0.5f), 0.5f);
+
+    float previous = 0.0f;
+    bool monotonic = true;
+    for (int i = 1; i <= 100; i++)
+    {
+        float eased = Ease::apply((float)i / 100.0f);
+        monotonic = monotonic && eased >= previous;
+        previous = eased;
+    }
+    EXPECT_TRUE(monotonic);
+}
+
+TEST(CubicBezier, LinearControlPointsMatchLinear)
+{
+    typedef CubicBezier<333, 333, 667, 667> Straight;
+    for (int i = 0; i <= 10; i++)
+    {
+        float t = (float)i / 10.0f;
+        EXPECT_NEAR(Straight::apply(t), Linear::apply(t), 1e-4f);
+    }
+}
+
+TEST(Steps, JumpsAtTheEndOfEachStep)
+{
+    EXPECT_EQ(Steps<4>::apply(0.0f), 0.0f);
+    EXPECT_EQ(Steps<4>::apply(0.24f), 0.0f);
+    EXPECT_EQ(Steps<4>::apply(0.25f), 0.25f);
+    EXPECT_EQ(Steps<4>::apply(0.99f), 0.75f);
+    EXPECT_EQ(Steps<4>::apply(1.0f), 1.0f);
+}
+
+TEST(Spring, OvershootsAndSettles)
+{
+    typedef Spring<20, 300> Bouncy;
+    EXPECT_NEAR(Bouncy::apply(0.0f), 0.0f, 1e-6f);
+
+    float peak = 0.0f;
+    for (int i = 0; i <= 100; i++)
+    {
+        peak = std::max(peak, Bouncy::apply((float)i / 100.0f));
+    }
+    EXPECT_GT(peak, 1.0f);
+    EXPECT_NEAR(Bouncy::apply(1.0f), 1.0f, 0.01f);
+}
+
+TEST(Animation, EasingShapesTheWrittenValue)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    Animation<float, EaseIn> animation;
+    animation.property = &property;
+    animation.start = 0.0f;
+    animation.end = 100.0f;
+    animation.duration = 100;
+    animation.prep(0);
+
+    animation.tick(50000);
+    EXPECT_NEAR(property.value, 100.0f * EaseIn::apply(0.5f), 1e-3f);
+    EXPECT_LT(property.value, 50.0f);
+}
+
+TEST(Tabulated, StaysWithinTheDocumentedErrorOfItsCurve)
+{
+    float worst_bezier = 0.0f;
+    float worst_spring = 0.0f;
+    for (int i = 0; i <= 1000; i++)
+    {
+        float t = (float)i / 1000.0f;
+        worst_bezier = std::max(worst_bezier, std::fabs(Tabulated<EaseInOut>::apply(t) - EaseInOut::apply(t)));
+        worst_spring = std::max(worst_spring,
+                                std::fabs(Tabulated<Spring<20, 300>, 1024>::apply(t) - Spring<20, 300>::apply(t)));
+    }
+    EXPECT_LT(worst_bezier, 3e-5f);
+    EXPECT_LT(worst_spring, 5e-5f);
+}
+
+TEST(Tabulated, ClampsProgressOutsideTheUnitRange)
+{
+    EXPECT_EQ(Tabulated<EaseOut>::apply(-0.5f), Tabulated<EaseOut>::apply(0.0f));
+    EXPECT_EQ(Tabulated<EaseOut>::apply(1.5f), Tabulated<EaseOut>::apply(1.0f));
+}
@@ -0,0 +1,122 @@
+#include "check.h"
+
+#include "observable.h"
+
+TEST(FrameDriver, VsyncGapCountsMissedPeriods)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationScheduler scheduler;
+    FrameDriver driver(scheduler, 100);
+
+    Animation<float, EaseInOut> animation;
+    animation.property = &property;
+    animation.start = 0.0f;
+    animation.end = 1.0f;
+    animation.duration = 1000;
+    animation.prep(1000000);
+    scheduler.add(animation);
+
+    driver.on_vsync(1010000);
+    // Three periods later, two vsyncs were dropped
+    driver.on_vsync(1040000);
+    EXPECT_EQ(driver.missed_frames(), 2u);
+}
+
+TEST(FrameDriver, RunUntilIdleReturnsOnceAnimationsRetire)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationScheduler scheduler;
+    FrameDriver driver(scheduler, 240);
+
+    Animation<float, EaseInOut> animation;
+    animation.property = &property;
+    animation.start = 0.0f;
+    animation.end = 1.0f;
+    animation.duration = 20;
+    animation.prep();
+    scheduler.add(animation);
+
+    driver.run_until_idle();
+    EXPECT_EQ(scheduler.active(), 0u);
+    EXPECT_EQ(property.value, 1.0f);
+    EXPECT_GE(driver.frames(), 2u);
+}
+
+TEST(FrameDriver, IdleGapBetweenVsyncRunsIsNotMissed)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationScheduler scheduler;
+    FrameDriver driver(scheduler, 120);
+
+    // Nothing animating, the platform stops sending vsyncs
+    EXPECT_FALSE(driver.on_vsync(1000000));
+
+    Animation<float, EaseInOut> animation;
+    animation.property = &property;
+    animation.start = 0.0f;
+    animation.end = 1.0f;
+    animation.duration = 1000;
+    animation.prep();
+    scheduler.add(animation);
+
+    // Ten seconds later a new animation restarts vsync delivery
+    driver.on_vsync(11000000);
+    driver.on_vsync(11008333);
+    EXPECT_EQ(driver.missed_frames(), 0u);
+}
+
+TEST(FrameDriver, OnlyPausedGroupsLetTheDriverIdle)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationScheduler scheduler;
+    FrameDriver driver(scheduler, 100);
+
+    AnimationGroup<> group;
+    group.duration = 1000;
+    Animation<float> member;
+    member.property = &property;
+    member.start = 0.0f;
+    member.end = 1.0f;
+    group.add(member);
+    AnimationHandle handle = scheduler.add(group);
+
+    scheduler.find_group(handle)->pause(AnimationCore::now_us());
+    // One frame writes the frozen position, the next finds nothing to do
+    EXPECT_TRUE(driver.on_vsync(AnimationCore::now_us()));
+    EXPECT_FALSE(driver.on_vsync(AnimationCore::now_us() + 10000));
+    EXPECT_EQ(scheduler.active(), 1u);
+    EXPECT_EQ(scheduler.running(), 0u);
+
+    // run() would park here rather than spin on the frozen group
+    driver.run_until_idle();
+    EXPECT_EQ(scheduler.active(), 1u);
+    EXPECT_LT(driver.frames(), 4u);
+}
+
+TEST(FrameDriver, VsyncRunsFramesUntilIdle)
+{
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    AnimationScheduler scheduler;
+    FrameDriver driver(scheduler, 100);
+
+    Animation<float, EaseInOut> animation;
+    animation.property = &property;
+    animation.start = 0.0f;
+    animation.end = 1.0f;
+    animation.duration = 30;
+    AnimationCore::begin_frame(1000000);
+    scheduler.add(animation);
+    AnimationCore::end_frame();
+
+    EXPECT_TRUE(driver.on_vsync(1010000));
+    EXPECT_TRUE(driver.on_vsync(1020000));
+    EXPECT_FALSE(driver.on_vsync(1030000));
+    EXPECT_EQ(driver.frames(), 3u);
+    EXPECT_EQ(driver.missed_frames(), 0u);
+    EXPECT_EQ(property.value, 1.0f);
+}
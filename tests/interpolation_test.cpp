@@ -0,0 +1,100 @@
+#include "check.h"
+
+#include "observable.h"
+
+struct Angle
+{
+    float degrees;
+};
+
+// Takes the shorter way around the circle
+template <>
+struct LerpTraits<Angle>
+{
+    static constexpr Angle lerp(Angle start, Angle end, float prog)
+    {
+        float delta = end.degrees - start.degrees;
+        delta = delta > 180.0f ? delta - 360.0f : delta < -180.0f ? delta + 360.0f : delta;
+        return Angle{start.degrees + delta * prog};
+    }
+};
+
+static_assert(lerp(0, 10, 0.5f) == 5, "integral lerp is constexpr");
+static_assert(lerp(2.0f, 4.0f, 0.25f) == 2.5f, "float lerp is constexpr");
+static_assert(lerp(RGBA8::make(0, 0, 0), RGBA8::make(255, 255, 255), 1.0f) == RGBA8::make(255, 255, 255),
+              "RGBA8 lerp is constexpr");
+
+TEST(Lerp, IntegersRoundToNearest)
+{
+    EXPECT_EQ(lerp(0, 10, 0.24f), 2);
+    EXPECT_EQ(lerp(0, 10, 0.26f), 3);
+    EXPECT_EQ(lerp(10, 0, 0.26f), 7);
+    EXPECT_EQ(lerp(-100, 100, 0.5f), 0);
+    // Overshooting easings such as springs extrapolate past the ends
+    EXPECT_EQ(lerp(0, 100, 1.1f), 110);
+    EXPECT_EQ(lerp(0, 100, -0.1f), -10);
+    EXPECT_EQ(lerp(int64_t(0), int64_t(1) << 40, 0.5f), int64_t(1) << 39);
+}
+
+TEST(Lerp, IntegersStayExactOverLargeRanges)
+{
+    EXPECT_EQ(lerp(0, 1000000, 0.3f), 300000);
+    EXPECT_EQ(lerp(0, -1000000, 0.3f), -300000);
+    EXPECT_EQ(lerp(INT32_MIN, INT32_MAX, 0.5f), 0);
+    EXPECT_EQ(lerp(INT32_MAX, INT32_MIN, 1.0f), INT32_MIN);
+    EXPECT_EQ(lerp(uint32_t(0), UINT32_MAX, 1.0f), UINT32_MAX);
+    EXPECT_EQ(lerp(int64_t(0), int64_t(1000000000000), 0.25f), int64_t(250000000000));
+    EXPECT_EQ(lerp(uint64_t(0), UINT64_MAX, 1.0f), UINT64_MAX);
+    EXPECT_EQ(lerp(INT64_MIN, INT64_MAX, 0.5f), int64_t(0));
+}
+
+TEST(Lerp, IntegersRoundHalfAwayFromZeroSymmetrically)
+{
+    EXPECT_EQ(lerp(0, 3, 0.5f), 2);
+    EXPECT_EQ(lerp(0, -3, 0.5f), -2);
+    EXPECT_EQ(lerp(10, 7, 0.5f), 8);
+    EXPECT_EQ(lerp(-10, -7, 0.5f), -8);
+    EXPECT_EQ(lerp(0, 1, 0.5f), 1);
+    EXPECT_EQ(lerp(0, -1, 0.5f), -1);
+}
+
+TEST(Lerp, FloatingPointKeepsItsPrecision)
+{
+    double start = 1e12;
+    EXPECT_EQ(lerp(start, start + 1.0, 0.5f), start + 0.5);
+    EXPECT_EQ(lerp(3.0f, 7.0f, 0.0f), 3.0f);
+    EXPECT_EQ(lerp(3.0f, 7.0f, 1.0f), 7.0f);
+}
+
+TEST(Lerp, RGBA8BlendsChannelsIndependently)
+{
+    RGBA8 start = RGBA8::make(0, 255, 10, 0);
+    RGBA8 end = RGBA8::make(255, 0, 10, 255);
+
+    EXPECT_EQ(lerp(start, end, 0.0f), start);
+    EXPECT_EQ(lerp(start, end, 1.0f), end);
+    // Progress outside [0, 1] clamps rather than wrapping a channel
+    EXPECT_EQ(lerp(start, end, -0.5f), start);
+    EXPECT_EQ(lerp(start, end, 1.5f), end);
+
+    RGBA8 middle = lerp(start, end, 0.5f);
+    EXPECT_EQ(middle.r(), 128);
+    EXPECT_EQ(middle.g(), 128);
+    EXPECT_EQ(middle.b(), 10);
+    EXPECT_EQ(middle.a(), 128);
+}
+
+TEST(Lerp, CustomSpecialisationIsUsedByAnimations)
+{
+    EXPECT_NEAR(lerp(Angle{350.0f}, Angle{10.0f}, 0.5f).degrees, 360.0f, 1e-4f);
+
+    ObservableProperty<Angle> heading;
+    Animation<Angle> animation;
+    animation.property = &heading;
+    animation.start = Angle{350.0f};
+    animation.end = Angle{10.0f};
+    animation.duration = 100;
+    animation.prep(1000000);
+    animation.advance(1000000 + 25000);
+    EXPECT_NEAR(heading.value.degrees, 355.0f, 1e-4f);
+}
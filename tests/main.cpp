@@ -0,0 +1,7 @@
+#include "check.h"
+
+// observer_tests [Suite]
+int main(int argc, char **argv)
+{
+    return TestRegistry::run_all(argc > 1 ? argv[1] : nullptr);
+}
@@ -0,0 +1,117 @@
+#include "check.h"
+
+#include "observable.h"
+
+TEST(PackedView, UnobservedWritesOnlySetDirtyBits)
+{
+    size_t entries = ObserverSideTable<float>::global().size();
+    PackedView view;
+    view.width() = 500.0f;
+    view.r() = 255;
+
+    EXPECT_EQ(view.values.width, 500.0f);
+    EXPECT_EQ(view.values.r, 255);
+    EXPECT_EQ(view.take_dirty(), (uint32_t)(View::DIRTY_WIDTH | View::DIRTY_R));
+    EXPECT_FALSE(view.is_dirty());
+    EXPECT_EQ(ObserverSideTable<float>::global().size(), entries);
+}
+
+TEST(PackedView, ObserversLiveInTheSideTableUntilTheViewDies)
+{
+    size_t entries = ObserverSideTable<float>::global().size();
+    std::vector<std::pair<float, float> > seen;
+    {
+        PackedView view;
+        ObserverHandle handle = view.x().add_observer([&seen](float old, float current)
+                                                      { seen.emplace_back(old, current); });
+        EXPECT_EQ(ObserverSideTable<float>::global().size(), entries + 1);
+
+        view.x() = 3.0f;
+        {
+            PropertyBatch batch;
+            view.x() = 4.0f;
+            view.x() = 5.0f;
+        }
+        EXPECT_TRUE(view.x().remove_observer(handle));
+        view.x() = 6.0f;
+    }
+    EXPECT_EQ(ObserverSideTable<float>::global().size(), entries);
+
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0].first, 0.0f);
+    EXPECT_EQ(seen[0].second, 3.0f);
+    EXPECT_EQ(seen[1].first, 3.0f);
+    EXPECT_EQ(seen[1].second, 5.0f);
+}
+
+TEST(PackedView, ObserverMayDestroyTheView)
+{
+    size_t entries = ObserverSideTable<float>::global().size();
+    PackedView *view = new PackedView();
+    int later = 0;
+    view->x().add_observer([&view](float, float)
+                           {
+                               delete view;
+                               view = nullptr;
+                           });
+    view->x().add_observer([&later](float, float) { later++; });
+
+    view->x() = 1.0f;
+    EXPECT_EQ(view, nullptr);
+    EXPECT_EQ(later, 0);
+    EXPECT_EQ(ObserverSideTable<float>::global().size(), entries);
+}
+
+TEST(PackedView, ViewsDestroyedInsideABatchAreNotNotified)
+{
+    int calls = 0;
+    ViewTable table;
+    ViewId row = table.create();
+    table.width(row).add_observer([&calls](float, float) { calls++; });
+    PackedView *view = new PackedView();
+    view->y().add_observer([&calls](float, float) { calls++; });
+    {
+        PropertyBatch batch;
+        table.width(row) = 2.0f;
+        view->y() = 3.0f;
+        table.destroy(row);
+        delete view;
+    }
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(ViewTable, ColumnsAreDenseAndIdsGoStale)
+{
+    ViewTable table;
+    ViewId first = table.create();
+    ViewId second = table.create();
+    table.width(first) = 10.0f;
+    table.width(second) = 20.0f;
+    table.g(second) = 7;
+
+    const float *widths = table.float_column(PackedView::WIDTH);
+    EXPECT_EQ(widths[first.index], 10.0f);
+    EXPECT_EQ(widths[second.index], 20.0f);
+    EXPECT_EQ(table.int_column(PackedView::G)[second.index], 7);
+    EXPECT_EQ(table.take_dirty(second), (uint32_t)(View::DIRTY_WIDTH | View::DIRTY_G));
+
+    int calls = 0;
+    table.height(first).add_observer([&calls](float, float) { calls++; });
+    EXPECT_TRUE(table.destroy(first));
+    EXPECT_FALSE(table.destroy(first));
+    EXPECT_EQ(table.size(), 1u);
+
+    // The index is reused zeroed, without the destroyed view's observers
+    ViewId reused = table.create();
+    EXPECT_EQ(reused.index, first.index);
+    EXPECT_NE(reused.generation, first.generation);
+    EXPECT_EQ(table.float_column(PackedView::WIDTH)[reused.index], 0.0f);
+    table.height(reused) = 1.0f;
+    EXPECT_EQ(calls, 0);
+
+    // A stale id neither sees nor clears the reusing view's dirty bits
+    EXPECT_FALSE(table.alive(first));
+    EXPECT_EQ(table.take_dirty(first), 0u);
+    EXPECT_EQ(table.take_dirty(reused), (uint32_t)View::DIRTY_HEIGHT);
+    EXPECT_EQ(table.capacity(), 2u);
+}
@@ -0,0 +1,297 @@
+#include "check.h"
+
+#include "observable.h"
+
+TEST(ObservableProperty, NotifiesWithOldAndNewValue)
+{
+    ObservableProperty<float> property;
+    property.value = 1.0f;
+    float seen_old = 0.0f;
+    float seen_new = 0.0f;
+    property.add_observer([&](float old, float current)
+                          {
+                              seen_old = old;
+                              seen_new = current;
+                          });
+
+    property = 2.0f;
+    EXPECT_EQ(seen_old, 1.0f);
+    EXPECT_EQ(seen_new, 2.0f);
+    EXPECT_EQ(property.value, 2.0f);
+}
+
+TEST(ObservableProperty, StaleHandleDoesNotRemoveReusedSlot)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    int calls = 0;
+    ObserverHandle first = property.add_observer([](int, int) {});
+    ObserverHandle second = property.add_observer([](int, int) {});
+    EXPECT_TRUE(property.remove_observer(second));
+    property.add_observer([&calls](int, int) { calls++; });
+
+    EXPECT_FALSE(property.remove_observer(second));
+    EXPECT_TRUE(property.remove_observer(first));
+    property = 1;
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ObservableProperty, ObserverAddedDuringNotificationRunsFromNextWrite)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    int late_calls = 0;
+    bool added = false;
+    property.add_observer([&](int, int)
+                          {
+                              if (!added)
+                              {
+                                  added = true;
+                                  property.add_observer([&late_calls](int, int) { late_calls++; });
+                              }
+                          });
+
+    property = 1;
+    EXPECT_EQ(late_calls, 0);
+    property = 2;
+    EXPECT_EQ(late_calls, 1);
+    EXPECT_EQ(property.observers.size(), 2u);
+}
+
+TEST(ObservableProperty, ObserverRemovedDuringNotificationIsNotCalledAgain)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    int victim_calls = 0;
+    ObserverHandle victim;
+    property.add_observer([&](int, int) { property.remove_observer(victim); });
+    victim = property.add_observer([&victim_calls](int, int) { victim_calls++; });
+
+    property = 1;
+    property = 2;
+    EXPECT_EQ(victim_calls, 0);
+    EXPECT_EQ(property.observers.size(), 1u);
+}
+
+TEST(ObservableProperty, ObserverCanRemoveItself)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    int calls = 0;
+    ObserverHandle self;
+    self = property.add_observer([&](int, int)
+                                 {
+                                     calls++;
+                                     property.remove_observer(self);
+                                 });
+
+    property = 1;
+    property = 2;
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(property.observers.empty());
+}
+
+TEST(ObservableProperty, InlineObserverHandleGoesStaleOnReuse)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    int calls = 0;
+    ObserverHandle first = property.add_observer([](int, int) {});
+    ObserverHandle spilled = property.add_observer([&calls](int, int) { calls++; });
+    EXPECT_TRUE(property.remove_observer(first));
+    ObserverHandle reused = property.add_observer([&calls](int, int) { calls += 10; });
+
+    EXPECT_FALSE(property.remove_observer(first));
+    property = 1;
+    EXPECT_EQ(calls, 11);
+
+    // Copies keep the observers and the handles that address them
+    ObservableProperty<int> copy = property;
+    EXPECT_TRUE(copy.remove_observer(reused));
+    EXPECT_TRUE(copy.remove_observer(spilled));
+    EXPECT_TRUE(copy.observers.empty());
+    EXPECT_EQ(property.observers.size(), 2u);
+}
+
+TEST(ObservableProperty, StaysCompactWithoutObservers)
+{
+    // One inline observer and out-of-line spill, dependents and batch state
+    EXPECT_LT(sizeof(ObservableProperty<float>), 96u);
+}
+
+TEST(ObservableProperty, SubscriptionDisconnectsOnDestruction)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    int calls = 0;
+    {
+        Subscription subscription = property.subscribe([&calls](int, int) { calls++; });
+        property = 1;
+    }
+    property = 2;
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ObservableProperty, NotifyOnChangeSkipsEqualWrites)
+{
+    ObservableProperty<int, NotifyOnChange> property;
+    property.value = 3;
+    int calls = 0;
+    property.add_observer([&calls](int, int) { calls++; });
+
+    property = 3;
+    property = 4;
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ObservableProperty, NotifyOutsideEpsilonKeepsTheLastNotifiedValue)
+{
+    ObservableProperty<float, NotifyOutsideEpsilon> property;
+    property.value = 1.0f;
+    std::vector<float> seen;
+    property.add_observer([&seen](float, float current) { seen.push_back(current); });
+
+    // Each write is within epsilon of the stored value, so the value never drifts
+    property = 1.00005f;
+    property = 1.00009f;
+    EXPECT_EQ(property.value, 1.0f);
+
+    property = 1.001f;
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0], 1.001f);
+    EXPECT_EQ(property.value, 1.001f);
+}
+
+TEST(ObservableProperty, PullModeOnlyBumpsVersionAndDirtyBit)
+{
+    uint32_t dirty = 0;
+    ObservableProperty<float> property;
+    property.value = 0.0f;
+    property.mode = PropertyMode::Pull;
+    property.track(&dirty, 4);
+    int calls = 0;
+    property.add_observer([&calls](float, float) { calls++; });
+
+    property = 1.0f;
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(property.version, 1u);
+    EXPECT_EQ(dirty, 4u);
+}
+
+TEST(PropertyBatch, CoalescesWritesIntoOneNotification)
+{
+    ObservableProperty<float> property;
+    property.value = 1.0f;
+    int calls = 0;
+    float seen_old = 0.0f;
+    float seen_new = 0.0f;
+    property.add_observer([&](float old, float current)
+                          {
+                              calls++;
+                              seen_old = old;
+                              seen_new = current;
+                          });
+
+    {
+        PropertyBatch batch;
+        property = 2.0f;
+        property = 3.0f;
+        EXPECT_EQ(property.value, 3.0f);
+        EXPECT_EQ(calls, 0);
+    }
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(seen_old, 1.0f);
+    EXPECT_EQ(seen_new, 3.0f);
+}
+
+TEST(PropertyBatch, NestedBatchesDeliverAtOutermostCommit)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    int calls = 0;
+    property.add_observer([&calls](int, int) { calls++; });
+
+    {
+        PropertyBatch outer;
+        {
+            PropertyBatch inner;
+            property = 1;
+        }
+        EXPECT_EQ(calls, 0);
+        property = 2;
+    }
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(PropertyBatch, ObserverWritesDuringCommitAreDelivered)
+{
+    ObservableProperty<int> source;
+    source.value = 0;
+    ObservableProperty<int> mirror;
+    mirror.value = 0;
+    int mirror_calls = 0;
+    source.add_observer([&mirror](int, int current) { mirror = current * 2; });
+    mirror.add_observer([&mirror_calls](int, int) { mirror_calls++; });
+
+    {
+        PropertyBatch batch;
+        source = 1;
+        source = 5;
+    }
+    EXPECT_EQ(mirror.value, 10);
+    EXPECT_EQ(mirror_calls, 1);
+}
+
+TEST(PropertyBatch, CopyTakenInsideABatchNotifiesInLaterBatches)
+{
+    ObservableProperty<int> property;
+    property.value = 0;
+    property.add_observer([](int, int) {});
+
+    ObservableProperty<int> copy;
+    {
+        PropertyBatch batch;
+        property = 1;
+        copy = property;
+        ObservableProperty<int> constructed(property);
+        EXPECT_FALSE(constructed.batched);
+    }
+
+    int calls = 0;
+    copy.add_observer([&calls](int, int) { calls++; });
+    {
+        PropertyBatch batch;
+        copy = 2;
+    }
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(View, WritesSetDirtyBits)
+{
+    View view;
+    view.frame.size.width = 10.0f;
+    view.color.g = 3;
+    EXPECT_EQ(view.take_dirty(), (uint32_t)(View::DIRTY_WIDTH | View::DIRTY_G));
+    EXPECT_FALSE(view.is_dirty());
+}
+
+TEST(View, CopiedAggregatesAreDetachedFromTheView)
+{
+    View *view = new View();
+    view->frame.position.x = 4.0f;
+    view->take_dirty();
+
+    Point saved = view->frame.position;
+    saved.x = 8.0f;
+    EXPECT_FALSE(view->is_dirty());
+
+    // Assigning back keeps the view's own binding
+    view->frame.position = saved;
+    view->frame.position.y = 1.0f;
+    EXPECT_EQ(view->take_dirty(), (uint32_t)View::DIRTY_Y);
+
+    // Writing the copy once the view is gone touches nothing of it
+    delete view;
+    saved.x = 16.0f;
+    EXPECT_EQ(saved.x.value, 16.0f);
+}
@@ -0,0 +1,94 @@
+#include "check.h"
+
+#include "observable.h"
+
+static const int64_t START_US = 1000000;
+
+TEST(ViewSnapshot, RestoresValuesAndAnimationsWithoutFiringObservers)
+{
+    View source;
+    source.frame.size.width = 200.0f;
+    source.color.g = 9;
+    source.frame.position.x = 0.0f;
+    AnimationScheduler captured;
+    AnimationCore::begin_frame(START_US);
+    captured.animate_to(&source.frame.position.x, 100.0f, 100);
+    AnimationCore::end_frame();
+    captured.tick(START_US + 50000);
+
+    View *sources[] = {&source};
+    std::vector<unsigned char> image = ViewSnapshot::capture(sources, 1, &captured, START_US + 50000);
+
+    View target;
+    int notified = 0;
+    target.frame.size.width.add_observer([&notified](float, float) { notified++; });
+    AnimationScheduler resumed;
+    View *targets[] = {&target};
+    EXPECT_TRUE(ViewSnapshot::restore(image.data(), image.size(), targets, 1, &resumed, START_US));
+
+    EXPECT_EQ(target.frame.size.width.value, 200.0f);
+    EXPECT_EQ(target.color.g.value, 9);
+    EXPECT_NEAR(target.frame.position.x.value, 50.0f, 1e-3f);
+    EXPECT_EQ(notified, 0);
+    EXPECT_EQ(target.take_dirty() & View::DIRTY_WIDTH, (uint32_t)View::DIRTY_WIDTH);
+
+    // The resumed lane finishes the remaining half on the new scheduler
+    EXPECT_TRUE(resumed.animating(&target.frame.position.x));
+    resumed.tick(START_US + 50000);
+    EXPECT_EQ(target.frame.position.x.value, 100.0f);
+    EXPECT_FALSE(resumed.animating(&target.frame.position.x));
+}
+
+TEST(ViewSnapshot, RejectsTruncatedOrMismatchedImages)
+{
+    View source;
+    View *views[] = {&source};
+    std::vector<unsigned char> image = ViewSnapshot::capture(views, 1);
+
+    EXPECT_FALSE(ViewSnapshot::restore(image.data(), image.size() - 1, views, 1));
+    EXPECT_FALSE(ViewSnapshot::restore(image.data(), image.size(), views, 0));
+
+    std::vector<unsigned char> foreign = image;
+    SnapshotHeader header;
+    std::memcpy(&header, foreign.data(), sizeof(header));
+    header.byte_order = 0x04030201;
+    std::memcpy(foreign.data(), &header, sizeof(header));
+    EXPECT_FALSE(ViewSnapshot::restore(foreign.data(), foreign.size(), views, 1));
+
+    EXPECT_TRUE(ViewSnapshot::restore(image.data(), image.size(), views, 1));
+}
+
+TEST(ViewSnapshot, TableRoundTripsThroughAMappedFile)
+{
+    ViewTable source;
+    ViewId first = source.create();
+    ViewId removed = source.create();
+    ViewId last = source.create();
+    source.height(first) = 12.0f;
+    source.b(last) = 4;
+    source.destroy(removed);
+
+    const char *path = "observer_snapshot_test.bin";
+    EXPECT_TRUE(ViewSnapshot::save(path, ViewSnapshot::capture(source)));
+
+    ViewTable restored;
+    {
+        MappedSnapshot mapped(path);
+        ASSERT_EQ(mapped.valid(), true);
+        EXPECT_TRUE(ViewSnapshot::restore(mapped.data(), mapped.size(), restored));
+        // Only an empty table accepts an image
+        EXPECT_FALSE(ViewSnapshot::restore(mapped.data(), mapped.size(), restored));
+    }
+    std::remove(path);
+
+    EXPECT_EQ(restored.capacity(), 3u);
+    EXPECT_TRUE(restored.alive(ViewId{first.index, 1}));
+    EXPECT_TRUE(restored.alive(ViewId{last.index, 1}));
+    EXPECT_FALSE(restored.alive(ViewId{removed.index, 1}));
+    EXPECT_EQ(restored.float_column(PackedView::HEIGHT)[first.index], 12.0f);
+    EXPECT_EQ(restored.int_column(PackedView::B)[last.index], 4);
+    EXPECT_EQ(restored.take_dirty(ViewId{first.index, 1}), (uint32_t)(View::DIRTY_FRAME | View::DIRTY_COLOR));
+
+    // The destroyed index is the next one reused
+    EXPECT_EQ(restored.create().index, removed.index);
+}
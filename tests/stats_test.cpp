@@ -0,0 +1,64 @@
+#include "check.h"
+
+#include "observable.h"
+
+#include <sstream>
+
+TEST(AnimationStats, PercentilesCoverRecentFrames)
+{
+    // Fills the whole history, so earlier frames from other tests drop out
+    for (size_t i = 0; i < AnimationStats::HISTORY; i++)
+    {
+        int64_t start = 1000000 + (int64_t)i * 20000;
+        AnimationStats::begin_frame(start);
+        AnimationStats::end_frame(start + (i % 100 == 99 ? 16000 : 1000));
+    }
+
+    EXPECT_EQ(AnimationStats::last().frame_us, 1000);
+    EXPECT_EQ(AnimationStats::frame_percentile(0.5), 1000);
+    EXPECT_EQ(AnimationStats::frame_percentile(1.0), 16000);
+}
+
+TEST(AnimationStats, TraceHookReceivesFramesAsChromeJson)
+{
+    ChromeTraceWriter writer;
+    AnimationStats::set_trace_hook(&ChromeTraceWriter::record, &writer);
+    AnimationStats::begin_frame(5000);
+    AnimationStats::end_frame(5250);
+    AnimationStats::set_trace_hook(nullptr, nullptr);
+    AnimationStats::begin_frame(6000);
+    AnimationStats::end_frame(6100);
+
+    ASSERT_EQ(writer.size(), 1u);
+    std::ostringstream out;
+    writer.write(out);
+    EXPECT_EQ(out.str(),
+              std::string("{\"traceEvents\":[{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":5000,\"dur\":250}]}\n"));
+}
+
+#if OBSERVER_INSTRUMENTATION
+TEST(AnimationStats, CountsCallbacksCoalescingAndActiveAnimations)
+{
+    ObservableProperty<float> animated;
+    ObservableProperty<int> observed;
+    observed.add_observer([](int, int) {});
+    AnimationScheduler scheduler;
+
+    AnimationCore::begin_frame(1000000);
+    scheduler.animate_to(&animated, 1.0f, 100);
+    observed = 1;
+    {
+        PropertyBatch batch;
+        observed = 2;
+        observed = 3;
+    }
+    scheduler.tick(1000000 + 16000);
+    const FrameStats &frame = AnimationStats::current();
+    EXPECT_EQ(frame.observer_callbacks, 2u);
+    EXPECT_EQ(frame.notifications_coalesced, 1u);
+    EXPECT_EQ(frame.active_animations, 1u);
+    AnimationCore::end_frame();
+
+    EXPECT_EQ(AnimationStats::last().active_animations, 1u);
+}
+#endif
@@ -0,0 +1,38 @@
+#include "check.h"
+
+#include "observable.h"
+
+class CountingTraceSink : public TraceSink
+{
+public:
+    std::atomic<size_t> written{0};
+
+    void write(const TraceRecord *, size_t count) override
+    {
+        this->written.fetch_add(count);
+    }
+};
+
+TEST(TraceLog, ReinstalledSinkWakesTheIdleFlusher)
+{
+    TraceLog log(64, milliseconds(5));
+    CountingTraceSink sink;
+
+    log.set_sink(&sink);
+    log.record("first", 0.0, 1.0);
+    log.set_sink(nullptr);
+    EXPECT_EQ(sink.written.load(), 1u);
+
+    // Dropped, nothing is recorded without a sink
+    log.record("ignored", 1.0, 2.0);
+
+    // The flusher is asleep with no sink; installing one must resume timed flushes
+    log.set_sink(&sink);
+    log.record("second", 1.0, 2.0);
+    for (int i = 0; i < 200 && sink.written.load() < 2; i++)
+    {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    EXPECT_EQ(sink.written.load(), 2u);
+    log.set_sink(nullptr);
+}
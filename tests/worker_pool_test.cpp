@@ -0,0 +1,76 @@
+#include "check.h"
+
+#include "observable.h"
+
+static const int64_t START_US = 1000000;
+
+struct ChunkCounts
+{
+    std::vector<std::atomic<int> > calls;
+
+    explicit ChunkCounts(size_t chunks) : calls(chunks)
+    {
+    }
+
+    static void count(void *context, size_t chunk)
+    {
+        static_cast<ChunkCounts *>(context)->calls[chunk].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+TEST(AnimationWorkerPool, RunsEveryChunkExactlyOnce)
+{
+    AnimationWorkerPool pool(3);
+    EXPECT_EQ(pool.concurrency(), 4u);
+
+    // Repeated runs reuse the parked workers
+    for (size_t chunks : {1u, 2u, 7u, 1000u, 3u})
+    {
+        ChunkCounts counts(chunks);
+        pool.run(chunks, &ChunkCounts::count, &counts);
+        for (size_t i = 0; i < chunks; i++)
+        {
+            EXPECT_EQ(counts.calls[i].load(), 1);
+        }
+    }
+}
+
+TEST(AnimationWorkerPool, SchedulerMatchesSingleThreadedEvaluation)
+{
+    // Enough lanes for several parallel chunks
+    const size_t count = 20000;
+    std::vector<ObservableProperty<float> > serial(count);
+    std::vector<ObservableProperty<float> > parallel(count);
+
+    AnimationWorkerPool pool(3);
+    AnimationScheduler single;
+    AnimationScheduler threaded;
+    threaded.set_workers(&pool);
+
+    AnimationCore::begin_frame(START_US);
+    for (size_t i = 0; i < count; i++)
+    {
+        int64_t duration = 10 + (int64_t)(i % 90);
+        single.animate_to(&serial[i], 1.0f, duration);
+        threaded.animate_to(&parallel[i], 1.0f, duration);
+    }
+    AnimationCore::end_frame();
+
+    for (int64_t frame = 1; frame <= 7; frame++)
+    {
+        single.tick(START_US + frame * 16000);
+        threaded.tick(START_US + frame * 16000);
+        EXPECT_EQ(threaded.active(), single.active());
+        for (size_t i = 0; i < count; i++)
+        {
+            if (parallel[i].value != serial[i].value)
+            {
+                EXPECT_EQ(parallel[i].value, serial[i].value);
+                break;
+            }
+        }
+    }
+
+    EXPECT_EQ(threaded.active(), 0u);
+    EXPECT_EQ(parallel[count - 1].value, 1.0f);
+}